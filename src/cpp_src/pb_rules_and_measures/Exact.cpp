@@ -0,0 +1,166 @@
+#include "Exact.h"
+
+#include "MesEngine.h"
+#include "MesUtility.h"
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/Rational.h"
+
+#include <algorithm>
+#include <memory_resource>
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace {
+struct Candidate {
+    int index;
+    Rational value;
+};
+
+// The steps of mes_detail::MesRounds, with mes_detail::evaluate and mes_detail::pay in Rational.
+template <typename Utility>
+std::optional<std::vector<ProjectEmbedding>> mes_exact(const Election &election,
+                                                       const ProjectComparator &tie_breaking) {
+    const auto &projects = election.projects();
+    const auto &weights = election.voter_weights();
+    std::pmr::vector<Rational> budget(election.num_of_voter_classes(),
+                                      Rational(election.budget(), election.num_of_voters()));
+    std::vector<ProjectEmbedding> winners;
+
+    // the lazy evaluation of mes_apr: values only increase, so a round stops at the first stale value above the best
+    auto later = [](const Candidate &a, const Candidate &b) {
+        return a.value > b.value || (a.value == b.value && a.index > b.index);
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(later)> remaining_candidates(later);
+    for (int i = 0; i < static_cast<int>(projects.size()); i++) {
+        remaining_candidates.push({i, 0});
+    }
+    std::vector<Candidate> candidates_to_reinsert;
+    std::pmr::vector<int> approvers;
+    auto uniform_cost = election.uniform_cost();
+    auto unspent_budget = election.budget();
+
+    // with uniform costs, the payments add up to the costs exactly, so once the unspent budget is below the cost no
+    // project is affordable
+    while (!cancellation::requested() && !(uniform_cost && *uniform_cost > unspent_budget)) {
+        std::optional<Candidate> best;
+        while (!remaining_candidates.empty()) {
+            auto current_candidate = remaining_candidates.top();
+            if (best && current_candidate.value > best->value) {
+                break;
+            }
+            remaining_candidates.pop();
+            auto value = mes_detail::evaluate<Utility>(projects[current_candidate.index], budget, weights, approvers);
+            if (!value) {
+                continue;
+            }
+            if (!value->valid()) {
+                return {};
+            }
+            current_candidate.value = *value;
+            if (!best || current_candidate.value < best->value ||
+                (current_candidate.value == best->value &&
+                 tie_breaking(projects[current_candidate.index], projects[best->index]))) {
+                if (best) {
+                    candidates_to_reinsert.push_back(*best);
+                }
+                best = current_candidate;
+            } else {
+                candidates_to_reinsert.push_back(current_candidate);
+            }
+        }
+        if (!best) { // No more affordable projects
+            break;
+        }
+
+        const auto &winner = projects[best->index];
+        mes_detail::pay<Utility>(winner, best->value, budget);
+        if (!std::ranges::all_of(winner.approvers(), [&budget](int approver) { return budget[approver].valid(); })) {
+            return {};
+        }
+        winners.push_back(winner);
+        unspent_budget -= winner.cost();
+
+        for (auto &candidate : candidates_to_reinsert) {
+            remaining_candidates.push(candidate);
+        }
+        candidates_to_reinsert.clear();
+    }
+    return winners;
+}
+} // namespace
+
+std::optional<std::vector<ProjectEmbedding>> mes_apr_exact(const Election &election,
+                                                           const ProjectComparator &tie_breaking) {
+    return mes_exact<mes_detail::ApprovalUtility>(election, tie_breaking);
+}
+
+std::optional<std::vector<ProjectEmbedding>> mes_cost_exact(const Election &election,
+                                                            const ProjectComparator &tie_breaking) {
+    return mes_exact<mes_detail::CostUtility>(election, tie_breaking);
+}
+
+std::optional<std::vector<ProjectEmbedding>> phragmen_exact(const Election &election,
+                                                            const ProjectComparator &tie_breaking) {
+    auto total_budget = election.budget();
+    const auto &weights = election.voter_weights();
+    std::vector<Rational> load(election.num_of_voter_classes(), 0);
+    std::vector<ProjectEmbedding> winners;
+
+    std::vector<const ProjectEmbedding *> projects, round_winners;
+    for (const auto &project : election.projects()) {
+        projects.push_back(&project);
+    }
+
+    // projects without approvers have an infinite max load, represented by nothing
+    auto less = [](const std::optional<Rational> &a, const std::optional<Rational> &b) {
+        return a && (!b || *a < *b);
+    };
+    auto uniform_cost = election.uniform_cost();
+    while (!projects.empty() && !cancellation::requested()) {
+        if (uniform_cost && *uniform_cost > total_budget) {
+            break; // every round winner would be unaffordable, no need to find them
+        }
+
+        std::optional<Rational> min_max_load;
+        round_winners.clear();
+        for (const auto *project : projects) {
+            std::optional<Rational> max_load;
+            if (project->num_of_approvers() > 0) {
+                Rational total_load = project->cost();
+                for (const auto &approver : project->approvers()) {
+                    total_load = total_load + load[approver] * weights[approver];
+                }
+                max_load = total_load / project->num_of_approvers();
+                if (!max_load->valid()) {
+                    return {};
+                }
+            }
+            if (round_winners.empty() || less(max_load, min_max_load)) {
+                round_winners.clear();
+                min_max_load = max_load;
+            }
+            if (!less(min_max_load, max_load)) {
+                round_winners.push_back(project);
+            }
+        }
+        if (std::ranges::any_of(round_winners,
+                                [total_budget](const auto *winner) { return winner->cost() > total_budget; })) {
+            break;
+        }
+
+        auto dereference = [](const ProjectEmbedding *project) -> const ProjectEmbedding & { return *project; };
+        const auto &winner = **std::ranges::min_element(round_winners, tie_breaking, dereference);
+        for (const auto &approver : winner.approvers()) {
+            load[approver] = *min_max_load;
+        }
+
+        winners.push_back(winner);
+        total_budget -= winner.cost();
+        projects.erase(std::ranges::find(projects, &winner));
+    }
+    return winners;
+}
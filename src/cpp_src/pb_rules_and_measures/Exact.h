@@ -0,0 +1,19 @@
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+
+#include <optional>
+#include <vector>
+
+// The rules computed with exact rational arithmetic (see utils/Rational.h) instead of long double with pbmath::EPS, so
+// that values are only tied, and tie_breaking only used, when they are exactly equal, as with exact fractions in
+// pabutools. Winners are in order of selection; nothing is returned if some intermediate value does not fit.
+
+std::optional<std::vector<ProjectEmbedding>> mes_apr_exact(const Election &election,
+                                                           const ProjectComparator &tie_breaking);
+
+std::optional<std::vector<ProjectEmbedding>> mes_cost_exact(const Election &election,
+                                                            const ProjectComparator &tie_breaking);
+
+std::optional<std::vector<ProjectEmbedding>> phragmen_exact(const Election &election,
+                                                            const ProjectComparator &tie_breaking);
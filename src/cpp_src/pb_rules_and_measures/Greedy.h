@@ -9,6 +9,11 @@ std::vector<ProjectEmbedding> greedy(const Election &election, const ProjectComp
 
 long long cost_reduction_for_greedy(const Election &election, int p, const ProjectComparator &tie_breaking);
 
+// Highest price at which pp would win the tie-breaking against project, which has the same score and is selected
+// before it (0 if there is none).
+long long price_to_win_tie_for_greedy(const ProjectEmbedding &pp, const ProjectEmbedding &project,
+                                      const ProjectComparator &tie_breaking);
+
 std::optional<int> optimist_add_for_greedy(const Election &election, int p, const ProjectComparator &tie_breaking);
 
 std::optional<int> pessimist_add_for_greedy(const Election &election, int p, const ProjectComparator &tie_breaking);
@@ -9,13 +9,28 @@
 #include <optional>
 #include <vector>
 
+namespace {
+// Highest price, at most max_price, at which p wins the tie-breaking against project (0 if there is none), when both
+// have the same ratio at every price. Only the prices at which tie-breakings by cost can change their order are tried.
+long long max_price_to_precede(const ProjectEmbedding &pp, const ProjectEmbedding &project, long long max_price,
+                               const ProjectComparator &tie_breaking) {
+    for (long long price : {max_price, std::min(project.cost(), max_price), std::min(project.cost() - 1, max_price)}) {
+        if (price > 0 &&
+            tie_breaking(ProjectEmbedding(price, pp.name(), pp.approvers(), pp.num_of_approvers()), project)) {
+            return price;
+        }
+    }
+    return 0;
+}
+} // namespace
+
 std::vector<ProjectEmbedding> greedy_over_cost(const Election &election, const ProjectComparator &tie_breaking) {
     auto total_budget = election.budget();
     auto projects = election.projects();
     std::vector<ProjectEmbedding> winners;
-    std::ranges::sort(projects, [&tie_breaking](ProjectEmbedding a, ProjectEmbedding b) {
-        long long cross_term_a_approvals_b_cost = a.num_of_approvers() * b.cost(),
-                  cross_term_b_approvals_a_cost = b.num_of_approvers() * a.cost();
+    std::ranges::sort(projects, [&tie_breaking](const ProjectEmbedding &a, const ProjectEmbedding &b) {
+        long long cross_term_a_approvals_b_cost = a.score() * b.cost(),
+                  cross_term_b_approvals_a_cost = b.score() * a.cost();
         if (cross_term_a_approvals_b_cost == cross_term_b_approvals_a_cost) {
             return tie_breaking(a, b);
         }
@@ -39,9 +54,9 @@ long long cost_reduction_for_greedy_over_cost(const Election &election, int p, c
 
     long long max_price_to_be_chosen = 0;
 
-    std::ranges::sort(projects, [&tie_breaking](ProjectEmbedding a, ProjectEmbedding b) {
-        long long cross_term_a_approvals_b_cost = a.num_of_approvers() * b.cost(),
-                  cross_term_b_approvals_a_cost = b.num_of_approvers() * a.cost();
+    std::ranges::sort(projects, [&tie_breaking](const ProjectEmbedding &a, const ProjectEmbedding &b) {
+        long long cross_term_a_approvals_b_cost = a.score() * b.cost(),
+                  cross_term_b_approvals_a_cost = b.score() * a.cost();
         if (cross_term_a_approvals_b_cost == cross_term_b_approvals_a_cost) {
             return tie_breaking(a, b);
         }
@@ -51,23 +66,9 @@ long long cost_reduction_for_greedy_over_cost(const Election &election, int p, c
         if (project.cost() <= total_budget) {
             if (project == pp) {
                 return pp.cost();
-            } else {
-                long long curr_max_price = 0;
-                if (project.num_of_approvers() == 0) {
-                    curr_max_price = project.cost();
-                } else {
-                    curr_max_price = std::min(
-                        static_cast<long long>(project.cost() * pp.num_of_approvers() / project.num_of_approvers()),
-                        total_budget); // todo: change if price doesn't have to be long long
-                }
-
-                if (pp.num_of_approvers() * project.cost() == project.num_of_approvers() * curr_max_price &&
-                    tie_breaking(project, ProjectEmbedding(curr_max_price, pp.name(), pp.approvers()))) {
-                    curr_max_price--;
-                }
-
-                max_price_to_be_chosen = std::max(max_price_to_be_chosen, curr_max_price);
             }
+            max_price_to_be_chosen = std::max(
+                max_price_to_be_chosen, price_to_precede_for_greedy_over_cost(pp, project, total_budget, tie_breaking));
             total_budget -= project.cost();
         } else if (project == pp) { // not taken because budget too tight
             max_price_to_be_chosen = std::max(max_price_to_be_chosen, total_budget);
@@ -76,6 +77,21 @@ long long cost_reduction_for_greedy_over_cost(const Election &election, int p, c
     return max_price_to_be_chosen;
 }
 
+long long price_to_precede_for_greedy_over_cost(const ProjectEmbedding &pp, const ProjectEmbedding &project,
+                                                long long total_budget, const ProjectComparator &tie_breaking) {
+    if (project.score() == 0) {
+        // p comes first at any price if it has approvers, otherwise the tie-breaking alone decides
+        return pp.score() > 0 ? total_budget : max_price_to_precede(pp, project, total_budget, tie_breaking);
+    }
+    long long max_price = std::min(static_cast<long long>(project.cost() * pp.score() / project.score()),
+                                   total_budget); // todo: change if price doesn't have to be long long
+    if (pp.score() * project.cost() == project.score() * max_price &&
+        tie_breaking(project, ProjectEmbedding(max_price, pp.name(), pp.approvers(), pp.num_of_approvers()))) {
+        max_price--;
+    }
+    return max_price;
+}
+
 std::optional<int> optimist_add_for_greedy_over_cost(const Election &election, int p,
                                                      const ProjectComparator &tie_breaking) {
     auto total_budget = election.budget();
@@ -86,7 +102,7 @@ std::optional<int> optimist_add_for_greedy_over_cost(const Election &election, i
         return {}; // LCOV_EXCL_LINE (every project should be feasible)
 
     std::vector<ProjectEmbedding> winners;
-    std::ranges::sort(projects, [&tie_breaking](ProjectEmbedding a, ProjectEmbedding b) {
+    std::ranges::sort(projects, [&tie_breaking](const ProjectEmbedding &a, const ProjectEmbedding &b) {
         long long cross_term_a_approvals_b_cost = a.num_of_approvers() * b.cost(),
                   cross_term_b_approvals_a_cost = b.num_of_approvers() * a.cost();
         if (cross_term_a_approvals_b_cost == cross_term_b_approvals_a_cost) {
@@ -134,7 +150,7 @@ std::optional<int> singleton_add_for_greedy_over_cost(const Election &election,
         return {}; // LCOV_EXCL_LINE (every project should be feasible)
 
     std::vector<ProjectEmbedding> winners;
-    std::ranges::sort(projects, [&tie_breaking](ProjectEmbedding a, ProjectEmbedding b) {
+    std::ranges::sort(projects, [&tie_breaking](const ProjectEmbedding &a, const ProjectEmbedding &b) {
         long long cross_term_a_approvals_b_cost = a.num_of_approvers() * b.cost(),
                   cross_term_b_approvals_a_cost = b.num_of_approvers() * a.cost();
         if (cross_term_a_approvals_b_cost == cross_term_b_approvals_a_cost) {
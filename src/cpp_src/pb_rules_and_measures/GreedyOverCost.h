@@ -9,6 +9,11 @@ std::vector<ProjectEmbedding> greedy_over_cost(const Election &election, const P
 
 long long cost_reduction_for_greedy_over_cost(const Election &election, int p, const ProjectComparator &tie_breaking);
 
+// Highest price, at most total_budget, at which pp would be selected instead of project, which is selected before it
+// with total_budget left (0 if there is none).
+long long price_to_precede_for_greedy_over_cost(const ProjectEmbedding &pp, const ProjectEmbedding &project,
+                                                long long total_budget, const ProjectComparator &tie_breaking);
+
 std::optional<int> optimist_add_for_greedy_over_cost(const Election &election, int p,
                                                      const ProjectComparator &tie_breaking);
 
@@ -0,0 +1,95 @@
+#include "GreedyTally.h"
+#include "Greedy.h"
+#include "GreedyOverCost.h"
+
+#include <algorithm>
+#include <vector>
+
+GreedyTally::GreedyTally(const Election &election, const ProjectComparator &tie_breaking, bool over_cost)
+    : budget_(election.budget()), tie_breaking_(tie_breaking), over_cost_(over_cost), ranking_(RankedBefore{this}) {
+    projects_.reserve(election.projects().size());
+    for (const auto &project : election.projects()) {
+        projects_.emplace_back(project.cost(), project.name(), std::vector<int>{}, project.num_of_approvers());
+    }
+    for (int i = 0; i < static_cast<int>(projects_.size()); i++) {
+        ranking_.insert(ranking_.end(), i);
+    }
+}
+
+// Same order as the sorts of greedy and greedy_over_cost.
+bool GreedyTally::RankedBefore::operator()(int i, int j) const {
+    const auto &a = tally->projects_[i], &b = tally->projects_[j];
+    if (tally->over_cost_) {
+        long long cross_term_a_approvals_b_cost = a.num_of_approvers() * b.cost(),
+                  cross_term_b_approvals_a_cost = b.num_of_approvers() * a.cost();
+        if (cross_term_a_approvals_b_cost == cross_term_b_approvals_a_cost) {
+            return tally->tie_breaking_(a, b);
+        }
+        return cross_term_a_approvals_b_cost > cross_term_b_approvals_a_cost;
+    }
+    if (a.num_of_approvers() == b.num_of_approvers()) {
+        return tally->tie_breaking_(a, b);
+    }
+    return a.num_of_approvers() > b.num_of_approvers();
+}
+
+void GreedyTally::update(const std::vector<int> &approved, int change) {
+    for (int index : approved) {
+        // the key of a project must not change while it is in the set
+        ranking_.erase(index);
+        projects_[index].num_of_approvers_ += change;
+        projects_[index].score_ += change;
+        ranking_.insert(index);
+    }
+}
+
+void GreedyTally::add_ballot(const std::vector<int> &approved) { update(approved, 1); }
+
+void GreedyTally::retract_ballot(const std::vector<int> &approved) { update(approved, -1); }
+
+std::vector<int> GreedyTally::allocation() const {
+    auto total_budget = budget_;
+    std::vector<int> winners;
+    for (int index : ranking_) {
+        const auto &project = projects_[index];
+        if (project.cost() <= total_budget) {
+            winners.push_back(index);
+            total_budget -= project.cost();
+        }
+        if (total_budget <= 0)
+            break;
+    }
+    return winners;
+}
+
+long long GreedyTally::cost_reduction(int p) const {
+    auto total_budget = budget_;
+    const auto &pp = projects_[p];
+
+    long long max_price_to_be_chosen = 0;
+
+    for (int index : ranking_) {
+        const auto &project = projects_[index];
+        if (!over_cost_ && project.num_of_approvers() < pp.num_of_approvers()) {
+            break;
+        }
+        if (project.cost() <= total_budget) {
+            if (index == p) {
+                return pp.cost();
+            }
+            // the same prices as cost_reduction_for_greedy(_over_cost), which read the ranking of a sorted copy
+            if (over_cost_) {
+                max_price_to_be_chosen =
+                    std::max(max_price_to_be_chosen,
+                             price_to_precede_for_greedy_over_cost(pp, project, total_budget, tie_breaking_));
+            } else if (project.num_of_approvers() == pp.num_of_approvers()) { // Not taken because lost tie-breaking
+                max_price_to_be_chosen =
+                    std::max(max_price_to_be_chosen, price_to_win_tie_for_greedy(pp, project, tie_breaking_));
+            }
+            total_budget -= project.cost();
+        } else if (index == p) { // not taken because budget too tight
+            max_price_to_be_chosen = std::max(max_price_to_be_chosen, total_budget);
+        }
+    }
+    return max_price_to_be_chosen;
+}
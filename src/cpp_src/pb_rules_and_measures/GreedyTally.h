@@ -0,0 +1,41 @@
+#pragma once
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+
+#include <set>
+#include <vector>
+
+// Approval counts of an ongoing vote, kept sorted by the ranking of GreedyAV (or GreedyAV/Cost if over_cost) so that a
+// ballot approving k of the m projects is added or retracted in O(k log m). The allocation and the cost reduction
+// measure are read off the ranking in a single pass, without sorting the projects or building approver lists.
+class GreedyTally {
+  public:
+    // Starts from the approval counts of the election, approver lists are not kept.
+    GreedyTally(const Election &election, const ProjectComparator &tie_breaking, bool over_cost);
+
+    GreedyTally(const GreedyTally &) = delete;
+    GreedyTally &operator=(const GreedyTally &) = delete;
+
+    // approved are indices into election.projects()
+    void add_ballot(const std::vector<int> &approved);
+    void retract_ballot(const std::vector<int> &approved);
+
+    // Indices of the selected projects, in order of selection.
+    std::vector<int> allocation() const;
+    long long cost_reduction(int p) const;
+
+  private:
+    struct RankedBefore {
+        const GreedyTally *tally;
+        bool operator()(int i, int j) const;
+    };
+
+    long long budget_;
+    std::vector<ProjectEmbedding> projects_;
+    ProjectComparator tie_breaking_;
+    bool over_cost_;
+    std::set<int, RankedBefore> ranking_;
+
+    void update(const std::vector<int> &approved, int change);
+};
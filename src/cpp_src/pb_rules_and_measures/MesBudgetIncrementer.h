@@ -0,0 +1,273 @@
+#pragma once
+#include "MesUtility.h"
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/Math.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// Incremental MES engine shared by the add1 completions and the budget sweeps. Approval ballots only: payments and
+// comparisons weigh every approver equally, so the bindings reject elections with cardinal ballots.
+namespace mes_detail {
+struct Candidate {
+    int index;
+    long double max_payment_per_utility;
+    long double slope; // derivative of max_payment_per_utility with respect to the voter budget
+    int version;       // stale heap entries (older versions) are skipped
+
+    bool operator>(const Candidate &other) const { return max_payment_per_utility > other.max_payment_per_utility; }
+};
+
+// Runs MES for a growing initial budget of every voter, keeping state between consecutive runs:
+// - each run replays the winners of the previous one: the previous winner of a round is evaluated first and serves as
+//   the bound for the lazy heap, so rounds whose decision did not change only touch candidates that could beat it;
+// - as long as all decisions of a run stay the same, every budget (and every compared quantity) is an affine function
+//   of the initial voter budget. We track the slopes and, for each comparison the run made, how far the voter budget
+//   can grow before the comparison flips. Increments below the smallest such distance cannot change any decision.
+template <typename Utility> class MesBudgetIncrementer {
+  public:
+    MesBudgetIncrementer(const Election &election, const ProjectComparator &tie_breaking)
+        : projects_(election.projects()), weights_(election.voter_weights()), tie_breaking_(tie_breaking),
+          budget_(election.num_of_voter_classes()), budget_slope_(election.num_of_voter_classes()),
+          version_(projects_.size(), 0) {
+        remaining_candidates_.reserve(projects_.size());
+        candidates_to_reinsert_.reserve(projects_.size());
+    }
+
+    // Returns indices of the winning projects (in order of selection) for the given initial budget of every voter.
+    const std::vector<int> &run(long double voter_budget) {
+        std::ranges::fill(budget_, voter_budget);
+        std::ranges::fill(budget_slope_, 1.0L);
+        previous_winners_.swap(winners_);
+        winners_.clear();
+        max_safe_increment_ = std::numeric_limits<long double>::max();
+
+        remaining_candidates_.clear();
+        for (int i = 0; i < static_cast<int>(projects_.size()); i++) {
+            remaining_candidates_.emplace_back(i, 0, 0, ++version_[i]);
+        }
+        std::ranges::make_heap(remaining_candidates_, std::greater<Candidate>());
+
+        bool replaying = true;
+        while (!cancellation::requested()) {
+            Candidate best{-1, std::numeric_limits<long double>::max(), 0, 0};
+            evaluated_.clear();
+            pruned_.reset();
+
+            if (replaying && winners_.size() < previous_winners_.size()) {
+                int previous_winner = previous_winners_[winners_.size()];
+                version_[previous_winner]++; // its entry in the heap is outdated now
+                if (auto evaluated = evaluate(previous_winner)) {
+                    best = *evaluated;
+                    evaluated_.push_back(best);
+                }
+            }
+
+            while (!remaining_candidates_.empty()) {
+                std::ranges::pop_heap(remaining_candidates_, std::greater<Candidate>());
+                auto current_candidate = remaining_candidates_.back();
+                remaining_candidates_.pop_back();
+                if (current_candidate.version != version_[current_candidate.index]) {
+                    continue;
+                }
+
+                if (pbmath::is_greater_than(current_candidate.max_payment_per_utility, best.max_payment_per_utility)) {
+                    candidates_to_reinsert_.push_back(current_candidate);
+                    pruned_ = current_candidate;
+                    break; // We already selected the best possible - max_payment_per_utility value can only increase
+                }
+
+                auto evaluated = evaluate(current_candidate.index);
+                if (!evaluated) {
+                    continue;
+                }
+                evaluated_.push_back(*evaluated);
+                if (pbmath::is_less_than(evaluated->max_payment_per_utility, best.max_payment_per_utility) ||
+                    (pbmath::is_equal(evaluated->max_payment_per_utility, best.max_payment_per_utility) &&
+                     best.index != -1 && tie_breaking_(projects_[evaluated->index], projects_[best.index]))) {
+                    if (best.index != -1) { // Not the first "best" candidate
+                        candidates_to_reinsert_.push_back(best);
+                    }
+                    best = *evaluated;
+                } else {
+                    candidates_to_reinsert_.push_back(*evaluated);
+                }
+            }
+
+            if (best.index == -1) { // No more affordable projects
+                break;
+            }
+            if (replaying &&
+                (winners_.size() >= previous_winners_.size() || previous_winners_[winners_.size()] != best.index)) {
+                replaying = false; // first round whose decision changed
+            }
+            winners_.push_back(best.index);
+            version_[best.index]++;
+
+            if (tracking()) {
+                track_selection(best);
+            }
+
+            const auto &winner = projects_[best.index];
+            long double utility = Utility::utility(winner.cost());
+            long double payment_slope = best.slope * utility;
+            for (const auto &approver : winner.approvers()) {
+                long double remaining = budget_[approver] - best.max_payment_per_utility * utility;
+                if (tracking()) {
+                    long double remaining_slope = budget_slope_[approver] - payment_slope;
+                    if (remaining > 0) {
+                        keep_above(remaining, remaining_slope, 0);
+                        budget_slope_[approver] = remaining_slope;
+                    } else {
+                        keep_at_most(remaining, remaining_slope, 0);
+                        budget_slope_[approver] = 0;
+                    }
+                }
+                budget_[approver] = std::max(0.0L, remaining);
+            }
+
+            for (auto &candidate : candidates_to_reinsert_) {
+                remaining_candidates_.push_back(candidate);
+                std::ranges::push_heap(remaining_candidates_, std::greater<Candidate>());
+            }
+            candidates_to_reinsert_.clear();
+        }
+
+        return winners_;
+    }
+
+    // Number of budget increments (by 1 for every voter) after which the outcome of the last run can change for the
+    // first time; 1 if we cannot guarantee anything, the maximal value if the outcome can never change.
+    long long safe_increments() const {
+        if (max_safe_increment_ >= static_cast<long double>(std::numeric_limits<long long>::max())) {
+            return std::numeric_limits<long long>::max();
+        }
+        // one increment of margin, so that rounding errors in the slopes cannot matter
+        return std::max(1LL, static_cast<long long>(std::ceil(max_safe_increment_)) - 1);
+    }
+
+    // Whether the last run would have the same outcome with every voter budget raised by increment (with the same
+    // margin as safe_increments).
+    bool unchanged_after(long double increment) const { return increment < max_safe_increment_ - 1; }
+
+  private:
+    const std::vector<ProjectEmbedding> &projects_;
+    const std::vector<int> &weights_;
+    const ProjectComparator &tie_breaking_;
+    std::vector<long double> budget_, budget_slope_;
+    std::vector<int> version_;
+    std::vector<int> winners_, previous_winners_;
+    std::vector<int> approvers_;
+    std::vector<Candidate> remaining_candidates_; // min-heap on max_payment_per_utility
+    std::vector<Candidate> candidates_to_reinsert_, evaluated_;
+    std::optional<Candidate> pruned_; // the candidate at which the lazy heap stopped in the current round
+    long double max_safe_increment_ = std::numeric_limits<long double>::max();
+
+    // Once some decision can flip within a single increment, there is nothing left to gain from tracking slopes.
+    bool tracking() const { return max_safe_increment_ > 1; }
+
+    // The affine quantity value + slope * increment must stay above threshold (resp. at most threshold).
+    void keep_above(long double value, long double slope, long double threshold) {
+        if (slope < 0) {
+            max_safe_increment_ = std::min(max_safe_increment_, (value - threshold) / -slope);
+        }
+    }
+    void keep_at_most(long double value, long double slope, long double threshold) {
+        if (slope > 0) {
+            max_safe_increment_ = std::min(max_safe_increment_, (threshold - value) / slope);
+        }
+    }
+
+    // The winner must keep beating every candidate evaluated in this round, and every candidate left in the heap must
+    // keep a lower bound that is too large to compete.
+    void track_selection(const Candidate &best) {
+        for (const auto &candidate : evaluated_) {
+            if (candidate.index == best.index) {
+                continue;
+            }
+            long double difference = candidate.max_payment_per_utility - best.max_payment_per_utility;
+            long double difference_slope = candidate.slope - best.slope;
+            if (pbmath::is_greater_than(candidate.max_payment_per_utility, best.max_payment_per_utility)) {
+                keep_above(difference, difference_slope, pbmath::EPS);
+            } else { // lost tie-breaking
+                keep_above(difference, difference_slope, -pbmath::EPS);
+                keep_at_most(difference, difference_slope, pbmath::EPS);
+            }
+        }
+        auto keep_pruned = [this, &best](const Candidate &candidate) {
+            keep_above(candidate.max_payment_per_utility - best.max_payment_per_utility, candidate.slope - best.slope,
+                       pbmath::EPS);
+        };
+        if (pruned_) {
+            keep_pruned(*pruned_);
+        }
+        for (const auto &candidate : remaining_candidates_) {
+            if (candidate.version == version_[candidate.index]) {
+                keep_pruned(candidate);
+            }
+        }
+    }
+
+    // Returns the candidate with its current max payment per unit of utility, or nothing if it is not affordable.
+    std::optional<Candidate> evaluate(int index) {
+        const auto &project = projects_[index];
+        long double money_behind_project = 0, money_slope = 0;
+        for (const auto &approver : project.approvers()) {
+            money_behind_project += weights_[approver] * budget_[approver];
+            money_slope += weights_[approver] * budget_slope_[approver];
+        }
+
+        if (pbmath::is_less_than(money_behind_project, project.cost())) {
+            if (tracking()) {
+                keep_above(project.cost() - money_behind_project, -money_slope, pbmath::EPS);
+            }
+            return {};
+        }
+        if (tracking()) {
+            keep_at_most(project.cost() - money_behind_project, -money_slope, pbmath::EPS);
+        }
+
+        approvers_.assign(project.approvers().begin(), project.approvers().end());
+        std::ranges::sort(approvers_, [this](const int a, const int b) { return budget_[a] < budget_[b]; });
+
+        long double paid_so_far = 0, paid_slope = 0, denominator = project.num_of_approvers();
+        for (int i = 0; i < static_cast<int>(approvers_.size()); i++) {
+            int approver = approvers_[i];
+            long double max_payment = (static_cast<long double>(project.cost()) - paid_so_far) / denominator;
+            long double max_payment_slope = -paid_slope / denominator;
+            if (tracking() && i > 0) { // the order of the voters checked so far must not change
+                keep_above(budget_[approver] - budget_[approvers_[i - 1]],
+                           budget_slope_[approver] - budget_slope_[approvers_[i - 1]], 0);
+            }
+            if (pbmath::is_greater_than(max_payment, budget_[approver])) { // cannot afford to fully participate
+                if (tracking()) {
+                    keep_above(max_payment - budget_[approver], max_payment_slope - budget_slope_[approver],
+                               pbmath::EPS);
+                }
+                paid_so_far += weights_[approver] * budget_[approver];
+                paid_slope += weights_[approver] * budget_slope_[approver];
+                denominator -= weights_[approver];
+            } else { // from this voter, everyone can fully participate
+                if (tracking()) {
+                    keep_at_most(max_payment - budget_[approver], max_payment_slope - budget_slope_[approver],
+                                 pbmath::EPS);
+                    for (int j = i + 1; j < static_cast<int>(approvers_.size()); j++) {
+                        keep_above(budget_[approvers_[j]] - budget_[approver],
+                                   budget_slope_[approvers_[j]] - budget_slope_[approver], 0);
+                    }
+                }
+                long double utility = Utility::utility(project.cost());
+                return Candidate{index, max_payment / utility, max_payment_slope / utility, version_[index]};
+            }
+        }
+        return {}; // LCOV_EXCL_LINE (affordable projects always have a fully participating voter)
+    }
+};
+} // namespace mes_detail
@@ -0,0 +1,134 @@
+#include "MesCompletion.h"
+
+#include "Greedy.h"
+#include "GreedyOverCost.h"
+#include "MesBudgetIncrementer.h"
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/Math.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace {
+using mes_detail::ApprovalUtility;
+using mes_detail::CostUtility;
+using mes_detail::MesBudgetIncrementer;
+
+template <typename Utility>
+std::vector<int> mes_add1_indices(const Election &election, const ProjectComparator &tie_breaking) {
+    auto total_budget = election.budget();
+    auto n_voters = election.num_of_voters();
+    const auto &projects = election.projects();
+
+    long long total_cost = 0;
+    for (const auto &project : projects) {
+        total_cost += project.cost();
+    }
+    auto allocation_cost = [&projects](const std::vector<int> &allocation) {
+        long long cost = 0;
+        for (int index : allocation) {
+            cost += projects[index].cost();
+        }
+        return cost;
+    };
+
+    MesBudgetIncrementer<Utility> engine(election, tie_breaking);
+    long long increments = 0;
+    auto voter_budget = [&]() {
+        return (static_cast<long double>(total_budget) + static_cast<long double>(increments) * n_voters) / n_voters;
+    };
+
+    std::vector<int> allocation = engine.run(voter_budget());
+    std::vector<char> selected(projects.size());
+    while (!cancellation::requested()) {
+        long long remaining_budget = total_budget - allocation_cost(allocation);
+        std::ranges::fill(selected, false);
+        for (int index : allocation) {
+            selected[index] = true;
+        }
+        bool exhaustive = true;
+        for (int i = 0; i < static_cast<int>(projects.size()); i++) {
+            if (!selected[i] && projects[i].cost() <= remaining_budget) {
+                exhaustive = false;
+                break;
+            }
+        }
+        // once every voter could fund all projects alone, nobody is ever capped and the outcome cannot change anymore
+        if (exhaustive || voter_budget() >= total_cost) {
+            break;
+        }
+
+        auto skip = engine.safe_increments();
+        if (skip == std::numeric_limits<long long>::max()) {
+            break; // no decision can change anymore
+        }
+        increments += skip;
+        const auto &next_allocation = engine.run(voter_budget());
+        if (allocation_cost(next_allocation) > total_budget) {
+            break;
+        }
+        allocation = next_allocation;
+    }
+    return allocation;
+}
+
+template <typename Utility>
+std::vector<ProjectEmbedding> mes_add1(const Election &election, const ProjectComparator &tie_breaking) {
+    std::vector<ProjectEmbedding> winners;
+    for (int index : mes_add1_indices<Utility>(election, tie_breaking)) {
+        winners.push_back(election.projects()[index]);
+    }
+    return winners;
+}
+
+using GreedyRule = std::vector<ProjectEmbedding> (*)(const Election &, const ProjectComparator &);
+
+template <typename Utility, GreedyRule utilitarian_rule>
+std::vector<ProjectEmbedding> mes_add1u(const Election &election, const ProjectComparator &tie_breaking) {
+    const auto &projects = election.projects();
+    auto allocation = mes_add1_indices<Utility>(election, tie_breaking);
+
+    std::vector<char> selected(projects.size());
+    long long remaining_budget = election.budget();
+    std::vector<ProjectEmbedding> winners;
+    for (int index : allocation) {
+        selected[index] = true;
+        remaining_budget -= projects[index].cost();
+        winners.push_back(projects[index]);
+    }
+    std::vector<ProjectEmbedding> remaining_projects;
+    for (int i = 0; i < static_cast<int>(projects.size()); i++) {
+        if (!selected[i]) {
+            remaining_projects.push_back(projects[i]);
+        }
+    }
+
+    auto completion = utilitarian_rule(
+        Election(remaining_budget, election.voter_weights(), std::move(remaining_projects)), tie_breaking);
+    winners.insert(winners.end(), completion.begin(), completion.end());
+    return winners;
+}
+} // namespace
+
+std::vector<ProjectEmbedding> mes_apr_add1(const Election &election, const ProjectComparator &tie_breaking) {
+    return mes_add1<ApprovalUtility>(election, tie_breaking);
+}
+
+std::vector<ProjectEmbedding> mes_apr_add1u(const Election &election, const ProjectComparator &tie_breaking) {
+    return mes_add1u<ApprovalUtility, greedy_over_cost>(election, tie_breaking);
+}
+
+std::vector<ProjectEmbedding> mes_cost_add1(const Election &election, const ProjectComparator &tie_breaking) {
+    return mes_add1<CostUtility>(election, tie_breaking);
+}
+
+std::vector<ProjectEmbedding> mes_cost_add1u(const Election &election, const ProjectComparator &tie_breaking) {
+    return mes_add1u<CostUtility, greedy>(election, tie_breaking);
+}
@@ -0,0 +1,16 @@
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+
+#include <vector>
+
+// MES completed by increasing the budget of every voter by 1 until the outcome would exceed the budget limit
+// (or is already exhaustive). The "u" variants additionally complete the result with the utilitarian greedy rule.
+
+std::vector<ProjectEmbedding> mes_apr_add1(const Election &election, const ProjectComparator &tie_breaking);
+
+std::vector<ProjectEmbedding> mes_apr_add1u(const Election &election, const ProjectComparator &tie_breaking);
+
+std::vector<ProjectEmbedding> mes_cost_add1(const Election &election, const ProjectComparator &tie_breaking);
+
+std::vector<ProjectEmbedding> mes_cost_add1u(const Election &election, const ProjectComparator &tie_breaking);
@@ -0,0 +1,898 @@
+#pragma once
+#include "MesUtility.h"
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/Math.h"
+#include "utils/PessimistModel.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/Rational.h"
+#include "utils/RoundLog.h"
+#include "utils/SensitivityPoint.h"
+#include "utils/ThreadPool.h"
+#include "utils/VoterTypes.h"
+#include "utils/Workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// MES and its measures for any additive utility of MesUtility.h. The rule files instantiate these templates with
+// their utility, so the utility is inlined into every comparison. With cardinal ballots, the utility of an approver is
+// its ballot utility times Utility::utility(cost); only the rule and the cost reduction support them, the other
+// measures add approvers and assume approval ballots.
+namespace mes_detail {
+struct RoundCandidate {
+    int index;
+    long double max_payment_per_utility;
+
+    // ties are broken by index, so the order of evaluation does not depend on the layout of the heap
+    bool operator>(const RoundCandidate &other) const {
+        return max_payment_per_utility > other.max_payment_per_utility ||
+               (max_payment_per_utility == other.max_payment_per_utility && index > other.index);
+    }
+};
+
+// Cardinal ballots: every approver pays min(budget, payment * utility) for the project, so the richest approvers per
+// unit of utility are the ones that pay in full. Sorts positions in the parallel arrays of the project by budget per
+// unit of utility.
+inline void sort_by_budget_per_utility(const ProjectEmbedding &project, const std::pmr::vector<long double> &budget,
+                                       std::pmr::vector<int> &positions) {
+    const auto &approvers = project.approvers();
+    const auto &utilities = project.utilities();
+    positions.resize(approvers.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    std::ranges::sort(positions, [&](const int a, const int b) {
+        return budget[approvers[a]] * utilities[b] < budget[approvers[b]] * utilities[a];
+    });
+}
+
+// Payment per unit of utility at which the approvers of a cardinal project, with positions sorted by
+// sort_by_budget_per_utility, pay the given cost, or nothing if they cannot afford it.
+inline std::optional<long double> cardinal_max_payment(long double cost, const ProjectEmbedding &project,
+                                                       const std::pmr::vector<int> &positions,
+                                                       const std::pmr::vector<long double> &budget,
+                                                       const std::vector<int> &weights) {
+    long double paid_so_far = 0, denominator = project.score();
+    for (const auto &position : positions) {
+        int approver = project.approvers()[position];
+        long double utility = project.utilities()[position];
+        long double max_payment = (cost - paid_so_far) / denominator;
+        if (pbmath::is_greater_than(max_payment * utility, budget[approver])) { // cannot afford to fully participate
+            paid_so_far += weights[approver] * budget[approver];
+            denominator -= weights[approver] * utility;
+        } else { // from this voter, everyone can fully participate
+            return max_payment;
+        }
+    }
+    return {};
+}
+
+// The steps below run in long double for the rules and measures, and in Rational for the exact rules: comparisons are
+// within EPS for the former and exact for the latter, which only use the integer utilities (approval and cost) and
+// approval ballots.
+inline bool is_less_than(long double a, long double b) { return pbmath::is_less_than(a, b); }
+inline bool is_greater_than(long double a, long double b) { return pbmath::is_greater_than(a, b); }
+inline bool is_less_than(const Rational &a, const Rational &b) { return a < b; }
+inline bool is_greater_than(const Rational &a, const Rational &b) { return a > b; }
+
+// Utility::utility(cost) in the arithmetic of Number.
+template <typename Utility, typename Number> auto utility_of(long long cost) {
+    if constexpr (std::is_same_v<Number, Rational>) {
+        return static_cast<long long>(Utility::utility(cost));
+    } else {
+        return Utility::utility(cost);
+    }
+}
+
+// Returns max_payment_per_utility of the project, or nothing if its supporters cannot afford it anymore. In Rational,
+// the value is invalid if the computation overflows.
+template <typename Utility, typename Number>
+std::optional<Number> evaluate(const ProjectEmbedding &project, const std::pmr::vector<Number> &budget,
+                               const std::vector<int> &weights, std::pmr::vector<int> &approvers) {
+    Number money_behind_project = 0;
+    for (const auto &approver : project.approvers()) {
+        money_behind_project += budget[approver] * weights[approver];
+    }
+
+    if (is_less_than(money_behind_project, project.cost())) {
+        return {};
+    }
+
+    if constexpr (std::is_floating_point_v<Number>) {
+        if (project.is_cardinal()) {
+            sort_by_budget_per_utility(project, budget, approvers);
+            auto max_payment = cardinal_max_payment(project.cost(), project, approvers, budget, weights);
+            if (!max_payment) {
+                return {}; // LCOV_EXCL_LINE (affordable projects always have a fully participating voter)
+            }
+            return *max_payment / Utility::utility(project.cost());
+        }
+    }
+
+    // Only the approvers that cannot fully participate are needed in order, and a re-validated candidate usually has
+    // few of them, so they are popped from a heap instead of sorting all approvers: O(k + p log k) for p poor voters.
+    approvers.assign(project.approvers().begin(), project.approvers().end());
+    auto richer = [&budget](const int a, const int b) { return budget[a] > budget[b]; };
+    std::ranges::make_heap(approvers, richer);
+
+    Number paid_so_far = 0;
+    long long denominator = project.num_of_approvers();
+
+    for (auto heap_end = approvers.end(); heap_end != approvers.begin(); heap_end--) {
+        std::ranges::pop_heap(approvers.begin(), heap_end, richer);
+        int approver = *(heap_end - 1);
+        Number max_payment = (Number(project.cost()) - paid_so_far) / denominator;
+        if (is_greater_than(max_payment, budget[approver])) { // cannot afford to fully participate
+            paid_so_far += budget[approver] * weights[approver];
+            denominator -= weights[approver];
+        } else { // from this voter, everyone can fully participate
+            return max_payment / utility_of<Utility, Number>(project.cost());
+        }
+    }
+    return {}; // LCOV_EXCL_LINE (affordable projects always have a fully participating voter)
+}
+
+// Selects the winner of a round: its approvers pay max_payment_per_utility for every unit of utility, or all they have
+// left. The payments are recorded in log, if given.
+template <typename Utility, typename Number>
+void pay(const ProjectEmbedding &winner, const Number &max_payment_per_utility, std::pmr::vector<Number> &budget,
+         RoundLog *log = nullptr) {
+    Number payment = max_payment_per_utility * utility_of<Utility, Number>(winner.cost());
+    const auto &approvers = winner.approvers();
+    for (int i = 0; i < approvers.size(); i++) {
+        Number paid = std::min(budget[approvers[i]], payment);
+        if constexpr (std::is_floating_point_v<Number>) {
+            if (winner.is_cardinal()) {
+                paid = std::min(budget[approvers[i]], payment * winner.utilities()[i]);
+            }
+            if (log) {
+                log->add_payment(approvers[i], paid);
+            }
+        }
+        budget[approvers[i]] -= paid;
+    }
+}
+
+// The rounds of MES with lazy evaluation: candidates sit in a min-heap keyed by their last max_payment_per_utility,
+// which can only increase, so a round stops at the first candidate whose old value is already worse than the best.
+//
+// With more than one thread, candidates are popped in batches and evaluated in parallel, then processed in the order
+// they were popped, exactly as the sequential loop would; the part of a batch after the stopping point is put back
+// untouched. With a single thread, batches have size 1. Containers live in the given workspace, so the rounds must not
+// outlive its scope.
+template <typename Utility> class MesRounds {
+  public:
+    MesRounds(const Election &election, const ProjectComparator &tie_breaking, Workspace &workspace,
+              int num_threads = 1)
+        : MesRounds(election, tie_breaking, workspace, {}, {}, num_threads) {}
+
+    // Resumes MES after earlier rounds that selected the given winners (indices into election.projects()) and left
+    // the voter classes with the given budgets, e.g. replayed from checkpoints. An empty budget starts from round one.
+    MesRounds(const Election &election, const ProjectComparator &tie_breaking, Workspace &workspace,
+              std::span<const long double> budget, std::span<const int> winners, int num_threads = 1)
+        : projects_(election.projects()), weights_(election.voter_weights()), tie_breaking_(tie_breaking),
+          n_classes_(election.num_of_voter_classes()),
+          budget_(n_classes_, static_cast<long double>(election.budget()) / election.num_of_voters(), &workspace),
+          remaining_candidates_(std::greater<RoundCandidate>(),
+                                workspace.reserved<RoundCandidate>(projects_.size())),
+          candidates_to_reinsert_(workspace.reserved<RoundCandidate>(projects_.size())), pool_(num_threads),
+          max_batch_size_(pool_.size() == 1 ? 1 : 16 * pool_.size()),
+          batch_(workspace.reserved<RoundCandidate>(max_batch_size_)),
+          batch_results_(workspace.reserved<std::optional<long double>>(max_batch_size_)),
+          uniform_cost_(election.uniform_cost()), unspent_budget_(election.budget()) {
+        if (!budget.empty()) {
+            budget_.assign(budget.begin(), budget.end());
+        }
+        auto is_winner = workspace.reserved<char>(projects_.size());
+        is_winner.resize(projects_.size(), false);
+        for (int winner : winners) {
+            is_winner[winner] = true;
+            unspent_budget_ -= projects_[winner].cost();
+        }
+        for (int i = 0; i < projects_.size(); i++) {
+            if (!is_winner[i]) {
+                remaining_candidates_.emplace(i, 0);
+            }
+        }
+    }
+
+    // Current budget of every voter class.
+    const std::pmr::vector<long double> &budget() const { return budget_; }
+
+    // Winner of the next round with its max_payment_per_utility, or nothing if no project is affordable anymore (or
+    // the computation is cancelled).
+    std::optional<RoundCandidate> next_winner() {
+        if (cancellation::requested()) {
+            return {};
+        }
+        if (uniform_cost_ && *uniform_cost_ > unspent_budget_) {
+            return {}; // the voters cannot afford any project, no need to evaluate them all to find out
+        }
+        std::optional<RoundCandidate> best_candidate;
+        bool round_finished = false;
+        int batch_size = pool_.size();
+
+        while (!round_finished && !remaining_candidates_.empty()) {
+            batch_.clear();
+            while (batch_.size() < batch_size && !remaining_candidates_.empty()) {
+                batch_.push_back(remaining_candidates_.top());
+                remaining_candidates_.pop();
+            }
+            batch_results_.resize(batch_.size());
+            pool_.parallel_for(batch_.size(), [&](int begin, int end) {
+                Workspace::Scope chunk_scope; // chunks run on the pool's threads, each with its own workspace
+                auto approvers = chunk_scope.workspace().reserved<int>(n_classes_);
+                for (int i = begin; i < end; i++) {
+                    batch_results_[i] = evaluate<Utility>(projects_[batch_[i].index], budget_, weights_, approvers);
+                }
+            });
+            batch_size = std::min(2 * batch_size, max_batch_size_);
+
+            for (int i = 0; i < batch_.size(); i++) {
+                auto current_candidate = batch_[i];
+                const auto &project = projects_[current_candidate.index];
+
+                if (best_candidate && pbmath::is_greater_than(current_candidate.max_payment_per_utility,
+                                                              best_candidate->max_payment_per_utility)) {
+                    candidates_to_reinsert_.insert(candidates_to_reinsert_.end(), batch_.begin() + i, batch_.end());
+                    round_finished = true;
+                    break; // We already selected the best possible - max_payment_per_utility value can only increase
+                }
+
+                if (!batch_results_[i]) {
+                    continue;
+                }
+
+                current_candidate.max_payment_per_utility = *batch_results_[i];
+                if (!best_candidate ||
+                    pbmath::is_less_than(current_candidate.max_payment_per_utility,
+                                         best_candidate->max_payment_per_utility) ||
+                    (pbmath::is_equal(current_candidate.max_payment_per_utility,
+                                      best_candidate->max_payment_per_utility) &&
+                     tie_breaking_(project, projects_[best_candidate->index]))) {
+                    if (best_candidate) { // Not the first "best" candidate
+                        candidates_to_reinsert_.push_back(*best_candidate);
+                    }
+                    best_candidate = current_candidate;
+                } else {
+                    candidates_to_reinsert_.push_back(current_candidate);
+                }
+            }
+        }
+
+        for (auto &candidate : candidates_to_reinsert_) {
+            remaining_candidates_.push(candidate);
+        }
+        candidates_to_reinsert_.clear();
+        return best_candidate;
+    }
+
+    // Selects the winner of the round: its approvers pay max_payment_per_utility for every unit of utility. The round
+    // and the payments are recorded in log, if given.
+    void select(const RoundCandidate &winner, RoundLog *log = nullptr) {
+        const auto &project = projects_[winner.index];
+        unspent_budget_ -= project.cost();
+        if (log) {
+            log->add_round(winner.index, winner.max_payment_per_utility);
+        }
+        pay<Utility>(project, winner.max_payment_per_utility, budget_, log);
+    }
+
+  private:
+    const std::vector<ProjectEmbedding> &projects_;
+    const std::vector<int> &weights_;
+    const ProjectComparator &tie_breaking_;
+    int n_classes_;
+    std::pmr::vector<long double> budget_;
+    WorkspaceMinHeap<RoundCandidate> remaining_candidates_;
+    std::pmr::vector<RoundCandidate> candidates_to_reinsert_;
+    ThreadPool pool_;
+    int max_batch_size_;
+    std::pmr::vector<RoundCandidate> batch_;
+    std::pmr::vector<std::optional<long double>> batch_results_;
+    // With uniform costs (committee elections), the rounds stop once the unspent budget, kept exactly in integers,
+    // is below the cost. The payments of every round add up to the cost of its winner, so the voter budgets differ
+    // from it only by rounding, far less than the shortfall of at least 1, and the rounds are the same as without it.
+    std::optional<long long> uniform_cost_;
+    long long unspent_budget_;
+};
+
+// Largest price at which pp, with its approvers sorted by budget, would be selected in the round instead of the
+// winner, -1 if there is none.
+template <typename Utility>
+long long price_to_win_round(const ProjectEmbedding &pp, const std::vector<int> &pp_approvers,
+                             const std::pmr::vector<long double> &budget, const std::vector<int> &weights,
+                             const ProjectEmbedding &winner, long double min_max_payment_per_utility,
+                             const ProjectComparator &tie_breaking) {
+    if constexpr (!Utility::depends_on_cost) {
+        long double min_max_payment = min_max_payment_per_utility * Utility::utility(pp.cost());
+        long double price_to_be_chosen = 0, full_participators_number = pp.num_of_approvers();
+        bool ties_with_winner = false; // otherwise all approvers pay everything, for less than min_max_payment each
+        for (const auto &approver : pp_approvers) {
+            if (pbmath::is_greater_than(min_max_payment, budget[approver])) { // cannot afford to fully participate
+                price_to_be_chosen += weights[approver] * budget[approver];
+                full_participators_number -= weights[approver];
+            } else {
+                price_to_be_chosen += full_participators_number * min_max_payment;
+                ties_with_winner = true;
+                break;
+            }
+        }
+
+        long double floored_price_to_be_chosen =
+            pbmath::floor(price_to_be_chosen); // todo: if price doesn't have to be long long, change here
+        if (ties_with_winner && pbmath::is_equal(floored_price_to_be_chosen, price_to_be_chosen) &&
+            tie_breaking(winner, ProjectEmbedding(floored_price_to_be_chosen, pp.name(), pp_approvers,
+                                                  pp.num_of_approvers()))) {
+            floored_price_to_be_chosen--;
+        }
+        return static_cast<long long>(floored_price_to_be_chosen);
+    } else {
+        // the utility changes with the price as well, so the price is searched for
+        // todo: try lowering complexity to O(1) per iteration
+        long long price_l = 0, price_r = pp.cost();
+        while (price_l + 1 < price_r) {
+            long long price_mid = (price_l + price_r) / 2;
+            long double paid_so_far = 0, denominator = pp.num_of_approvers();
+
+            for (const auto &approver : pp_approvers) {
+                long double max_payment = (static_cast<long double>(price_mid) - paid_so_far) / denominator;
+                long double max_payment_per_utility = max_payment / Utility::utility(price_mid);
+                if (pbmath::is_greater_than(max_payment, budget[approver])) { // cannot afford to fully participate
+                    paid_so_far += weights[approver] * budget[approver];
+                    denominator -= weights[approver];
+                } else { // from this voter, everyone can fully participate
+                    if (pbmath::is_less_than(max_payment_per_utility, min_max_payment_per_utility) ||
+                        (pbmath::is_equal(max_payment_per_utility, min_max_payment_per_utility) &&
+                         tie_breaking(ProjectEmbedding(price_mid, pp.name(), pp_approvers, pp.num_of_approvers()),
+                                      winner))) {
+                        price_l = price_mid;
+                    }
+                    break;
+                }
+            }
+            if (price_l != price_mid) {
+                price_r = price_mid;
+            }
+        }
+        return price_l;
+    }
+}
+
+// price_to_win_round for a project with cardinal ballots; positions is scratch space.
+template <typename Utility>
+long long cardinal_price_to_win_round(const ProjectEmbedding &pp, const std::pmr::vector<long double> &budget,
+                                      const std::vector<int> &weights, const ProjectEmbedding &winner,
+                                      long double min_max_payment_per_utility, const ProjectComparator &tie_breaking,
+                                      std::pmr::vector<int> &positions) {
+    const auto &approvers = pp.approvers();
+    auto pp_at = [&pp](long long price) {
+        return ProjectEmbedding(price, pp.name(), pp.approvers(), pp.num_of_approvers());
+    };
+
+    if constexpr (!Utility::depends_on_cost) {
+        long double min_max_payment = min_max_payment_per_utility * Utility::utility(pp.cost());
+        long double price_to_be_chosen = 0;
+        bool ties_with_winner = false; // otherwise all approvers pay everything, for less than they would in a tie
+        for (int i = 0; i < approvers.size(); i++) {
+            long double payment = min_max_payment * pp.utilities()[i];
+            if (pbmath::is_greater_than(payment, budget[approvers[i]])) { // cannot afford to fully participate
+                price_to_be_chosen += weights[approvers[i]] * budget[approvers[i]];
+            } else {
+                price_to_be_chosen += weights[approvers[i]] * payment;
+                ties_with_winner = true;
+            }
+        }
+
+        long double floored_price_to_be_chosen = pbmath::floor(price_to_be_chosen);
+        if (ties_with_winner && pbmath::is_equal(floored_price_to_be_chosen, price_to_be_chosen) &&
+            tie_breaking(winner, pp_at(floored_price_to_be_chosen))) {
+            floored_price_to_be_chosen--;
+        }
+        return static_cast<long long>(floored_price_to_be_chosen);
+    } else {
+        // the order of the approvers does not depend on the price, only the utility does
+        sort_by_budget_per_utility(pp, budget, positions);
+        long long price_l = 0, price_r = pp.cost();
+        while (price_l + 1 < price_r) {
+            long long price_mid = (price_l + price_r) / 2;
+            if (auto max_payment = cardinal_max_payment(price_mid, pp, positions, budget, weights)) {
+                long double max_payment_per_utility = *max_payment / Utility::utility(price_mid);
+                if (pbmath::is_less_than(max_payment_per_utility, min_max_payment_per_utility) ||
+                    (pbmath::is_equal(max_payment_per_utility, min_max_payment_per_utility) &&
+                     tie_breaking(pp_at(price_mid), winner))) {
+                    price_l = price_mid;
+                    continue;
+                }
+            }
+            price_r = price_mid;
+        }
+        return price_l;
+    }
+}
+
+// Fewest approvers that, added to pp, would make it selected in the round instead of the winner, nothing if there
+// are not enough voters. The richest non-approvers (in voters, sorted by budget) are added first, possibly only a part
+// of a class; pp_curr_weights is scratch space for the number of voters of each class approving pp.
+template <typename Utility>
+std::optional<int> approvers_to_win_round(const Election &election, const ProjectEmbedding &pp,
+                                          const std::pmr::vector<long double> &budget,
+                                          const std::pmr::vector<int> &voters,
+                                          const std::pmr::vector<bool> &is_pp_approver,
+                                          std::pmr::vector<int> &pp_curr_weights, const ProjectEmbedding &winner,
+                                          long double min_max_payment_per_utility,
+                                          const ProjectComparator &tie_breaking) {
+    auto n_voters = election.num_of_voters();
+    auto n_classes = election.num_of_voter_classes();
+    const auto &weights = election.voter_weights();
+
+    int low = -1, high = n_voters - pp.num_of_approvers() + 1;
+    while (low + 1 < high) {
+        int voters_to_be_added = (low + high) / 2;
+        for (int voter = 0; voter < n_classes; voter++) {
+            pp_curr_weights[voter] = is_pp_approver[voter] ? weights[voter] : 0;
+        }
+
+        for (int voters_idx = voters.size() - 1, voters_left = voters_to_be_added; voters_left > 0; voters_idx--) {
+            auto voter = voters[voters_idx];
+            if (!is_pp_approver[voter]) {
+                pp_curr_weights[voter] = std::min(weights[voter], voters_left);
+                voters_left -= pp_curr_weights[voter];
+            }
+        }
+
+        long double money_behind_project = 0;
+        for (const auto &voter : voters) {
+            money_behind_project += pp_curr_weights[voter] * budget[voter];
+        }
+        if (pbmath::is_greater_than(pp.cost(), money_behind_project)) {
+            low = voters_to_be_added;
+            continue;
+        }
+
+        long double paid_so_far = 0, denominator = pp.num_of_approvers() + voters_to_be_added;
+        for (const auto &voter : voters) {
+            if (pp_curr_weights[voter] == 0) {
+                continue;
+            }
+            auto &approver = voter;
+
+            long double max_payment = (static_cast<long double>(pp.cost()) - paid_so_far) / denominator;
+            long double max_payment_per_utility = max_payment / Utility::utility(pp.cost());
+            if (pbmath::is_greater_than(max_payment, budget[approver])) { // cannot afford to fully participate
+                paid_so_far += pp_curr_weights[approver] * budget[approver];
+                denominator -= pp_curr_weights[approver];
+            } else { // from this voter, everyone can fully participate
+                if (pbmath::is_less_than(max_payment_per_utility, min_max_payment_per_utility) ||
+                    (pbmath::is_equal(max_payment_per_utility, min_max_payment_per_utility) &&
+                     tie_breaking(ProjectEmbedding(pp.cost(), pp.name(), pp.approvers(),
+                                                   pp.num_of_approvers() + voters_to_be_added),
+                                  winner))) {
+                    high = voters_to_be_added;
+                } else {
+                    low = voters_to_be_added;
+                }
+                break;
+            }
+        }
+    }
+
+    if (high != n_voters - pp.num_of_approvers() + 1) {
+        return high;
+    }
+    return {};
+}
+
+// Fewest approvers that, added to pp, would let it be afforded by its supporters after the last round, nothing if
+// there are not enough voters; money_behind_project is what its supporters have (and then what they would have).
+inline std::optional<int> approvers_to_afford(const Election &election, const ProjectEmbedding &pp,
+                                                     const std::pmr::vector<long double> &budget,
+                                                     const std::pmr::vector<int> &voters,
+                                                     const std::pmr::vector<bool> &is_pp_approver,
+                                                     long double money_behind_project) {
+    const auto &weights = election.voter_weights();
+    int approvers_added = 0;
+
+    for (int voters_idx = voters.size() - 1; voters_idx >= 0 && pbmath::is_less_than(money_behind_project, pp.cost());
+         voters_idx--) {
+        auto voter = voters[voters_idx];
+        if (is_pp_approver[voter]) {
+            continue;
+        }
+        for (int added = 0; added < weights[voter] && pbmath::is_less_than(money_behind_project, pp.cost());
+             added++) {
+            approvers_added++;
+            money_behind_project += budget[voter];
+        }
+    }
+
+    if (!pbmath::is_less_than(money_behind_project, pp.cost())) {
+        return approvers_added;
+    }
+    return {};
+}
+
+inline long double money_behind(std::span<const int> approvers, const std::pmr::vector<long double> &budget,
+                                const std::vector<int> &weights) {
+    long double money = 0;
+    for (const auto &approver : approvers) {
+        money += weights[approver] * budget[approver];
+    }
+    return money;
+}
+
+// The per-round steps of the cost reduction and optimist add, shared with the sensitivity curve.
+
+// Largest price at which pp would be selected in the round instead of the winner, -1 if there is none; pp_approvers
+// (the approvers of pp) and positions are scratch space.
+template <typename Utility>
+long long price_in_round(const ProjectEmbedding &pp, std::vector<int> &pp_approvers,
+                         const std::pmr::vector<long double> &budget, const std::vector<int> &weights,
+                         const ProjectEmbedding &winner, long double min_max_payment_per_utility,
+                         const ProjectComparator &tie_breaking, std::pmr::vector<int> &positions) {
+    if (pp.is_cardinal()) {
+        return cardinal_price_to_win_round<Utility>(pp, budget, weights, winner, min_max_payment_per_utility,
+                                                    tie_breaking, positions);
+    }
+    std::ranges::sort(pp_approvers, [&budget](const int a, const int b) { return budget[a] < budget[b]; });
+    return price_to_win_round<Utility>(pp, pp_approvers, budget, weights, winner, min_max_payment_per_utility,
+                                       tie_breaking);
+}
+
+// Largest price at which pp would be afforded by its supporters after the last round.
+inline long long price_to_afford(std::span<const int> pp_approvers, const std::pmr::vector<long double> &budget,
+                                 const std::vector<int> &weights) {
+    // todo: if price doesn't have to be long long, change here
+    return static_cast<long long>(pbmath::floor(money_behind(pp_approvers, budget, weights)));
+}
+
+// Fewest approvers to add to pp in a round, with the voters sorted by budget anew for every round.
+template <typename Utility> class ApproversToAdd {
+  public:
+    ApproversToAdd(const Election &election, const ProjectEmbedding &pp, Workspace &workspace)
+        : election_(election), pp_(pp), voters_(election.num_of_voter_classes(), &workspace),
+          is_pp_approver_(election.num_of_voter_classes(), false, &workspace),
+          pp_curr_weights_(election.num_of_voter_classes(), &workspace) {
+        std::iota(voters_.begin(), voters_.end(), 0);
+        for (const auto &approver : pp.approvers()) {
+            is_pp_approver_[approver] = true;
+        }
+    }
+
+    // Fewest approvers to make pp selected in the round instead of the winner, as approvers_to_win_round.
+    std::optional<int> to_win_round(const std::pmr::vector<long double> &budget, const ProjectEmbedding &winner,
+                                    long double min_max_payment_per_utility, const ProjectComparator &tie_breaking) {
+        sort_voters(budget);
+        return approvers_to_win_round<Utility>(election_, pp_, budget, voters_, is_pp_approver_, pp_curr_weights_,
+                                               winner, min_max_payment_per_utility, tie_breaking);
+    }
+
+    // Fewest approvers to let pp be afforded after the last round, as approvers_to_afford.
+    std::optional<int> to_afford(const std::pmr::vector<long double> &budget, long double money_behind_project) {
+        sort_voters(budget);
+        return approvers_to_afford(election_, pp_, budget, voters_, is_pp_approver_, money_behind_project);
+    }
+
+  private:
+    const Election &election_;
+    const ProjectEmbedding &pp_;
+    std::pmr::vector<int> voters_;
+    std::pmr::vector<bool> is_pp_approver_;
+    std::pmr::vector<int> pp_curr_weights_;
+
+    void sort_voters(const std::pmr::vector<long double> &budget) {
+        std::ranges::sort(voters_, [&budget](const int a, const int b) { return budget[a] < budget[b]; });
+    }
+};
+
+template <typename Utility>
+std::vector<ProjectEmbedding> mes(const Election &election, const ProjectComparator &tie_breaking, int num_threads,
+                                  RoundLog *log = nullptr) {
+    const auto &projects = election.projects();
+    std::vector<ProjectEmbedding> winners;
+    if (log) {
+        log->clear();
+    }
+
+    Workspace::Scope scope;
+    MesRounds<Utility> rounds(election, tie_breaking, scope.workspace(), num_threads);
+
+    while (auto winner = rounds.next_winner()) {
+        winners.push_back(projects[winner->index]);
+        rounds.select(*winner, log);
+    }
+
+    return winners;
+}
+
+template <typename Utility>
+long long cost_reduction_for_mes(const Election &election, int p, const ProjectComparator &tie_breaking) {
+    const auto &weights = election.voter_weights();
+    const auto &projects = election.projects();
+    const auto &pp = projects[p];
+    std::vector<int> pp_approvers(pp.approvers().begin(), pp.approvers().end());
+    long long max_price_to_be_chosen = 0;
+
+    Workspace::Scope scope;
+    MesRounds<Utility> rounds(election, tie_breaking, scope.workspace());
+    const auto &budget = rounds.budget();
+    auto positions = scope.workspace().reserved<int>(pp_approvers.size());
+
+    while (true) {
+        auto best_candidate = rounds.next_winner();
+
+        if (!best_candidate) { // No more affordable projects
+            max_price_to_be_chosen = std::max(max_price_to_be_chosen, price_to_afford(pp_approvers, budget, weights));
+            break;
+        }
+
+        if (best_candidate->index == p) {
+            return pp.cost();
+        }
+
+        // pp cannot win a round for more than the money behind it (up to rounding), which only decreases, so once the
+        // best price exceeds it the searches of the remaining rounds are skipped
+        if (max_price_to_be_chosen > money_behind(pp_approvers, budget, weights)) {
+            rounds.select(*best_candidate);
+            continue;
+        }
+
+        max_price_to_be_chosen = std::max(
+            max_price_to_be_chosen,
+            price_in_round<Utility>(pp, pp_approvers, budget, weights, projects[best_candidate->index],
+                                    best_candidate->max_payment_per_utility, tie_breaking, positions));
+
+        rounds.select(*best_candidate);
+    }
+
+    return max_price_to_be_chosen;
+}
+
+template <typename Utility>
+std::optional<int> optimist_add_for_mes(const Election &election, int p, const ProjectComparator &tie_breaking) {
+    const auto &weights = election.voter_weights();
+    const auto &projects = election.projects();
+    const auto &pp = projects[p];
+    std::optional<int> min_number_of_added_approvers = std::nullopt;
+
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+    MesRounds<Utility> rounds(election, tie_breaking, workspace);
+    const auto &budget = rounds.budget();
+    ApproversToAdd<Utility> approvers_to_add(election, pp, workspace);
+
+    while (true) {
+        auto best_candidate = rounds.next_winner();
+
+        if (!best_candidate) { // No more affordable projects
+            if (auto added = approvers_to_add.to_afford(budget, money_behind(pp.approvers(), budget, weights))) {
+                min_number_of_added_approvers = pbmath::optional_min(min_number_of_added_approvers, *added);
+            }
+            break;
+        }
+
+        if (best_candidate->index == p) {
+            return 0;
+        }
+
+        if (auto added = approvers_to_add.to_win_round(budget, projects[best_candidate->index],
+                                                       best_candidate->max_payment_per_utility, tie_breaking)) {
+            min_number_of_added_approvers = pbmath::optional_min(min_number_of_added_approvers, *added);
+        }
+
+        rounds.select(*best_candidate);
+    }
+
+    return min_number_of_added_approvers;
+}
+
+template <typename Utility>
+std::vector<SensitivityPoint> sensitivity_curve_for_mes(const Election &election, int p,
+                                                        const ProjectComparator &tie_breaking) {
+    const auto &weights = election.voter_weights();
+    const auto &projects = election.projects();
+    const auto &pp = projects[p];
+    std::vector<int> pp_approvers(pp.approvers().begin(), pp.approvers().end());
+    std::vector<SensitivityPoint> curve;
+
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+    MesRounds<Utility> rounds(election, tie_breaking, workspace);
+    const auto &budget = rounds.budget();
+    auto positions = workspace.reserved<int>(pp_approvers.size());
+    ApproversToAdd<Utility> approvers_to_add(election, pp, workspace);
+
+    while (true) {
+        auto best_candidate = rounds.next_winner();
+
+        if (!best_candidate) { // No more affordable projects
+            curve.push_back({-1, price_to_afford(pp_approvers, budget, weights),
+                             approvers_to_add.to_afford(budget, money_behind(pp_approvers, budget, weights))});
+            break;
+        }
+
+        if (best_candidate->index == p) {
+            curve.push_back({p, pp.cost(), 0});
+            break;
+        }
+
+        // the price and the approvals at which pp would be selected in this round
+        const auto &winner = projects[best_candidate->index];
+        long double min_max_payment_per_utility = best_candidate->max_payment_per_utility;
+        curve.push_back({best_candidate->index,
+                         std::max(0LL, price_in_round<Utility>(pp, pp_approvers, budget, weights, winner,
+                                                               min_max_payment_per_utility, tie_breaking, positions)),
+                         approvers_to_add.to_win_round(budget, winner, min_max_payment_per_utility, tie_breaking)});
+        rounds.select(*best_candidate);
+    }
+
+    return curve;
+}
+
+template <typename Utility>
+std::optional<int> pessimist_add_for_mes(const Election &election, int p, const ProjectComparator &tie_breaking) {
+    auto total_budget = election.budget();
+    auto n_voters = election.num_of_voters();
+    const auto &weights = election.voter_weights();
+    const auto &projects = election.projects();
+    const auto &pp = projects[p];
+    std::vector<int> pp_approvers(pp.approvers().begin(), pp.approvers().end());
+
+    auto allocation = mes<Utility>(election, tie_breaking, 1);
+    if (std::ranges::find(allocation, pp) != allocation.end()) {
+        return 0;
+    }
+
+    const auto voter_types = calculate_voter_types(election, p, allocation);
+    int t = voter_types.size();
+
+    std::vector<int> voter_type_counts;
+    for (const auto &voter_type : voter_types) {
+        voter_type_counts.push_back(voter_type.first);
+    }
+    PessimistModel model(std::move(voter_type_counts));
+
+    Workspace::Scope scope;
+    MesRounds<Utility> rounds(election, tie_breaking, scope.workspace());
+    const auto &budget = rounds.budget();
+
+    while (true) {
+        auto best_candidate = rounds.next_winner();
+
+        if (pp.cost() > total_budget) {
+            break;
+        }
+
+        std::ranges::sort(pp_approvers, [&budget](const int a, const int b) { return budget[a] < budget[b]; });
+
+        { // ILP reduction constraints
+
+            if (!best_candidate) { // no more affordable projects
+                long double m_i = pp.cost() - money_behind(pp_approvers, budget, weights);
+
+                // we need a strict inequality; the solver's default precision is 1e-6, so need to exceed that
+                m_i = std::min(m_i - 1e-5, m_i * (1 - 1e-5));
+
+                std::vector<double> coefficients(t);
+                for (int j = 0; j < t; j++) {
+                    auto voter_type_example = voter_types[j].second;
+                    coefficients[j] = budget[voter_type_example];
+                }
+                model.add_round();
+                model.add_row(-std::numeric_limits<double>::infinity(), m_i, std::move(coefficients));
+
+                break;
+            }
+
+            const auto &winner = projects[best_candidate->index];
+            // the payment of every approver of pp that would tie it with the winner
+            long double min_max_payment = best_candidate->max_payment_per_utility * Utility::utility(pp.cost());
+
+            long double paid_so_far = 0, denominator = pp.num_of_approvers();
+            bool pp_has_rich_supporters = false;
+
+            for (const auto &approver : pp_approvers) {
+                if (pbmath::is_greater_than(min_max_payment, budget[approver])) {
+                    paid_so_far += weights[approver] * budget[approver];
+                    denominator -= weights[approver];
+                } else {
+                    paid_so_far += denominator * min_max_payment;
+                    pp_has_rich_supporters = true;
+                    break;
+                }
+            }
+
+            long double m_i = pp.cost() - paid_so_far;
+            long double m_i_strict = std::min(m_i - 1e-5, m_i * (1 - 1e-5));
+
+            // todo: what if tie-breaking depends on the number of votes?
+            if (tie_breaking(pp, winner)) {
+                // Case 1: pp WINS tie-breaking with current winner, we need a STRICT inequality
+                std::vector<double> coefficients(t);
+                for (int j = 0; j < t; j++) {
+                    auto voter_type_example = voter_types[j].second;
+                    coefficients[j] = std::min(min_max_payment, budget[voter_type_example]);
+                }
+                model.add_round();
+                model.add_row(-std::numeric_limits<double>::infinity(), m_i_strict, std::move(coefficients));
+            } else {
+                // Case 2: pp DOESN'T WIN tie-breaking with current winner, we need either a STRICT inequality or a
+                // WEAK inequality and guarantee max_payment is not less than min_max_payment
+
+                const long double M = election.budget() + 1.0;
+                std::vector<double> payments(t), rich_supporters(t);
+                for (int j = 0; j < t; j++) {
+                    auto voter_type_example = voter_types[j].second;
+                    if (pbmath::is_greater_than(min_max_payment, budget[voter_type_example])) {
+                        payments[j] = budget[voter_type_example];
+                    } else {
+                        payments[j] = min_max_payment;
+                        rich_supporters[j] = 1;
+                    }
+                }
+
+                // with y = 1 (case_2_disjunction) the strict inequality is dropped and a rich supporter is required
+                model.add_round(true);
+                model.add_row(-std::numeric_limits<double>::infinity(), m_i, payments);
+                model.add_row(-std::numeric_limits<double>::infinity(), m_i_strict, std::move(payments), -M);
+                model.add_row(1 - M - pp_has_rich_supporters, std::numeric_limits<double>::infinity(),
+                              std::move(rich_supporters), -M);
+            }
+        }
+
+        rounds.select(*best_candidate);
+        total_budget -= projects[best_candidate->index].cost();
+    }
+
+    auto result = model.maximize();
+    if (result && *result + 1 + pp.num_of_approvers() <= n_voters) {
+        return *result + 1;
+    }
+    return {};
+}
+
+template <typename Utility>
+std::optional<int> singleton_add_for_mes(const Election &election, int p, const ProjectComparator &tie_breaking) {
+    auto projects = election.projects();
+    auto budget = election.budget();
+    auto n_voters = election.num_of_voters();
+
+    auto &pp = projects[p];
+    std::vector<int> pp_approvers(pp.approvers().begin(), pp.approvers().end());
+
+    auto allocation = mes<Utility>(election, tie_breaking, 1);
+    if (std::ranges::find(allocation, pp) != allocation.end()) {
+        return 0;
+    }
+
+    if (pp.cost() == budget) {
+        return {};
+    }
+
+    int minimal_ans =
+        pbmath::ceil_div(static_cast<long long>(n_voters - pp.num_of_approvers()) * pp.cost(), budget - pp.cost());
+
+    // all added voters approve only pp, so they form a single new voter class
+    auto weights = election.voter_weights();
+    pp_approvers.push_back(weights.size());
+    weights.push_back(std::max(1, minimal_ans - pp.num_of_approvers()));
+    pp = ProjectEmbedding(pp.cost(), pp.name(), pp_approvers);
+
+    while (!cancellation::requested()) {
+        auto allocation = mes<Utility>(Election(budget, weights, projects), tie_breaking, 1);
+        if (std::ranges::find(allocation, pp) != allocation.end()) {
+            return weights.back();
+        }
+
+        weights.back()++;
+    }
+    return {};
+}
+} // namespace mes_detail
@@ -0,0 +1,42 @@
+#include "MesSqrtCost.h"
+
+#include "MesEngine.h"
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/RoundLog.h"
+#include "utils/SensitivityPoint.h"
+
+#include <optional>
+#include <vector>
+
+using mes_detail::SqrtCostUtility;
+
+std::vector<ProjectEmbedding> mes_sqrt_cost(const Election &election, const ProjectComparator &tie_breaking,
+                                            int num_threads, RoundLog *log) {
+    return mes_detail::mes<SqrtCostUtility>(election, tie_breaking, num_threads, log);
+}
+
+long long cost_reduction_for_mes_sqrt_cost(const Election &election, int p, const ProjectComparator &tie_breaking) {
+    return mes_detail::cost_reduction_for_mes<SqrtCostUtility>(election, p, tie_breaking);
+}
+
+std::optional<int> optimist_add_for_mes_sqrt_cost(const Election &election, int p,
+                                                  const ProjectComparator &tie_breaking) {
+    return mes_detail::optimist_add_for_mes<SqrtCostUtility>(election, p, tie_breaking);
+}
+
+std::vector<SensitivityPoint> sensitivity_curve_for_mes_sqrt_cost(const Election &election, int p,
+                                                                  const ProjectComparator &tie_breaking) {
+    return mes_detail::sensitivity_curve_for_mes<SqrtCostUtility>(election, p, tie_breaking);
+}
+
+std::optional<int> pessimist_add_for_mes_sqrt_cost(const Election &election, int p,
+                                                   const ProjectComparator &tie_breaking) {
+    return mes_detail::pessimist_add_for_mes<SqrtCostUtility>(election, p, tie_breaking);
+}
+
+std::optional<int> singleton_add_for_mes_sqrt_cost(const Election &election, int p,
+                                                   const ProjectComparator &tie_breaking) {
+    return mes_detail::singleton_add_for_mes<SqrtCostUtility>(election, p, tie_breaking);
+}
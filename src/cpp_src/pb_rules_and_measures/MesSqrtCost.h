@@ -0,0 +1,29 @@
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/RoundLog.h"
+#include "utils/SensitivityPoint.h"
+
+#include <optional>
+#include <vector>
+
+// Method of Equal Shares where every approver of a project gets the square root of its cost as utility.
+
+// num_threads > 1 evaluates the candidates of each round in parallel (0 means all hardware threads)
+// log, if given, is cleared and filled with the rounds of the rule and the payments of the voters
+std::vector<ProjectEmbedding> mes_sqrt_cost(const Election &election, const ProjectComparator &tie_breaking,
+                                            int num_threads = 1, RoundLog *log = nullptr);
+
+long long cost_reduction_for_mes_sqrt_cost(const Election &election, int p, const ProjectComparator &tie_breaking);
+
+std::optional<int> optimist_add_for_mes_sqrt_cost(const Election &election, int p,
+                                                  const ProjectComparator &tie_breaking);
+
+std::vector<SensitivityPoint> sensitivity_curve_for_mes_sqrt_cost(const Election &election, int p,
+                                                                  const ProjectComparator &tie_breaking);
+
+std::optional<int> pessimist_add_for_mes_sqrt_cost(const Election &election, int p,
+                                                   const ProjectComparator &tie_breaking);
+
+std::optional<int> singleton_add_for_mes_sqrt_cost(const Election &election, int p,
+                                                   const ProjectComparator &tie_breaking);
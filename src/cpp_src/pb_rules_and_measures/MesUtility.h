@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cmath>
+
+// Additive utilities of MES: every approver of a project of the given cost gets Utility::utility(cost) from it, and MES
+// selects the project with the lowest max payment per unit of utility. depends_on_cost tells the measures whether the
+// utility changes with the cost, in which case the price of a project is searched for instead of computed directly.
+namespace mes_detail {
+struct ApprovalUtility {
+    static constexpr bool depends_on_cost = false;
+    static long double utility(long long) { return 1; }
+};
+
+struct CostUtility {
+    static constexpr bool depends_on_cost = true;
+    static long double utility(long long cost) { return cost; }
+};
+
+// Between the two above: expensive projects count for more than cheap ones, but less than in proportion to their cost.
+struct SqrtCostUtility {
+    static constexpr bool depends_on_cost = true;
+    static long double utility(long long cost) { return std::sqrt(static_cast<long double>(cost)); }
+};
+} // namespace mes_detail
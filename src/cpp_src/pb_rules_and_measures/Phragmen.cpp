@@ -1,91 +1,184 @@
 #include "Phragmen.h"
 
-#include "Greedy.h"
+#include "PhragmenLoads.h"
+#include "utils/Cancellation.h"
 #include "utils/Election.h"
 #include "utils/Math.h"
+#include "utils/PessimistModel.h"
 #include "utils/ProjectComparator.h"
 #include "utils/ProjectEmbedding.h"
+#include "utils/RoundLog.h"
+#include "utils/SensitivityPoint.h"
 #include "utils/VoterTypes.h"
+#include "utils/Workspace.h"
 
 #include <algorithm>
 #include <limits>
+#include <memory_resource>
 #include <numeric>
-#include <queue>
-#include <unordered_set>
 #include <vector>
 
-#include "ortools/linear_solver/linear_solver.h"
+using phragmen_detail::PhragmenLoads;
+using phragmen_detail::PhragmenRounds;
 
-using namespace operations_research;
-
-std::vector<ProjectEmbedding> phragmen(const Election &election, const ProjectComparator &tie_breaking) {
-    // todo: try with max_load recalculation skipping
-    auto total_budget = election.budget();
-    auto n_voters = election.num_of_voters();
-    auto projects = election.projects();
-    std::vector<ProjectEmbedding> winners;
-    std::vector<long double> load(n_voters, 0);
+namespace {
+// Projects still in the running, as pointers into the election; rounds erase the winners from it.
+std::pmr::vector<const ProjectEmbedding *> remaining_projects(const Election &election, Workspace &workspace) {
+    auto projects = workspace.reserved<const ProjectEmbedding *>(election.projects().size());
+    for (const auto &project : election.projects()) {
+        projects.push_back(&project);
+    }
+    return projects;
+}
 
-    while (!projects.empty()) {
-        long double min_max_load = std::numeric_limits<long double>::max();
-        std::vector<ProjectEmbedding> round_winners;
-        for (const auto &project : projects) {
-            long double max_load = project.cost();
-            if (project.num_of_approvers() == 0) {
-                max_load = std::numeric_limits<long double>::max();
-            } else {
-                for (const auto &approver : project.approvers())
-                    max_load += load[approver];
-                max_load /= project.num_of_approvers();
-            }
+const ProjectEmbedding &round_winner(const std::pmr::vector<const ProjectEmbedding *> &round_winners,
+                                     const ProjectComparator &tie_breaking) {
+    auto dereference = [](const ProjectEmbedding *project) -> const ProjectEmbedding & { return *project; };
+    return **std::ranges::min_element(round_winners, tie_breaking, dereference);
+}
 
-            if (pbmath::is_less_than(max_load, min_max_load)) {
-                round_winners.clear();
-                min_max_load = max_load;
-            }
-            if (pbmath::is_equal(max_load, min_max_load)) {
-                round_winners.push_back(project);
-            }
+// Whether p, at the given price, is selected once only projects without approvers are left. They all tie, so they are
+// selected in the tie-breaking order, for as long as every one of them is affordable.
+bool selected_among_unapproved(const std::pmr::vector<const ProjectEmbedding *> &tied_projects,
+                               const ProjectEmbedding &pp, long long price, long long budget,
+                               const ProjectComparator &tie_breaking) {
+    std::vector<ProjectEmbedding> order;
+    for (const auto *project : tied_projects) {
+        order.push_back(*project == pp ? ProjectEmbedding(price, pp.name(), pp.approvers(), pp.num_of_approvers())
+                                       : *project);
+    }
+    std::ranges::sort(order, tie_breaking);
+    std::vector<long long> max_cost_from(order.size() + 1, 0);
+    for (int i = static_cast<int>(order.size()) - 1; i >= 0; i--) {
+        max_cost_from[i] = std::max(max_cost_from[i + 1], order[i].cost());
+    }
+    for (int i = 0; i < static_cast<int>(order.size()); i++) {
+        if (max_cost_from[i] > budget) {
+            return false;
         }
-        if (any_of(round_winners.begin(), round_winners.end(),
-                   [total_budget](const ProjectEmbedding &winner) { return winner.cost() > total_budget; })) {
-            break;
+        if (order[i].name() == pp.name()) {
+            return true;
+        }
+        budget -= order[i].cost();
+    }
+    return false; // LCOV_EXCL_LINE (p is one of the tied projects)
+}
+
+// Highest price, at most its cost, at which p is selected among the projects without approvers (0 if there is none).
+// Lowering the price of p can only move it forward in the tie-breaking and make it more affordable.
+long long max_price_among_unapproved(const std::pmr::vector<const ProjectEmbedding *> &tied_projects,
+                                     const ProjectEmbedding &pp, long long budget,
+                                     const ProjectComparator &tie_breaking) {
+    long long price_l = 0, price_r = pp.cost() + 1;
+    while (price_l + 1 < price_r) {
+        long long price_mid = (price_l + price_r) / 2;
+        if (selected_among_unapproved(tied_projects, pp, price_mid, budget, tie_breaking)) {
+            price_l = price_mid;
+        } else {
+            price_r = price_mid;
         }
+    }
+    return price_l;
+}
 
-        const auto &winner = *std::ranges::min_element(round_winners, tie_breaking);
+// The per-round steps of the cost reduction and optimist add, shared with the sensitivity curve.
+
+// Largest price, at most its cost and the budget left, at which pp (with approvers) would be selected in the round
+// instead of the winner; negative if there is none.
+long long price_in_round(const ProjectEmbedding &pp, const PhragmenLoads &loads, long double min_max_load,
+                         long long total_budget, const ProjectEmbedding &winner, bool would_break_without_pp,
+                         const ProjectComparator &tie_breaking) {
+    long double load_sum = loads.load_sum(pp);
+    long long curr_max_price = pbmath::floor(min_max_load * pp.num_of_approvers() - load_sum);
+    curr_max_price = std::min({curr_max_price, pp.cost(), total_budget});
+    long double pp_max_load = (curr_max_price + load_sum) / pp.num_of_approvers();
+
+    if (pbmath::is_equal(pp_max_load, min_max_load) &&
+        (would_break_without_pp ||
+         tie_breaking(winner, ProjectEmbedding(curr_max_price, pp.name(), pp.approvers(), pp.num_of_approvers())))) {
+        curr_max_price--;
+    }
+    return curr_max_price;
+}
 
-        for (const auto &approver : winner.approvers()) {
-            load[approver] = min_max_load;
+// Fewest approvers that, added to pp, would make it selected in the round instead of the winner, nothing if there
+// are not enough voters. The least loaded non-approvers are added first, possibly only a part of a class;
+// best_new_approvers is scratch space.
+std::optional<int> approvers_to_win_round(const ProjectEmbedding &pp, const PhragmenLoads &loads,
+                                          const std::vector<int> &weights,
+                                          const std::pmr::vector<bool> &is_pp_approver,
+                                          std::pmr::vector<std::pair<long double, int>> &best_new_approvers,
+                                          long double min_max_load, const ProjectEmbedding &winner, bool would_break,
+                                          const ProjectComparator &tie_breaking) {
+    const auto &load = loads.load();
+    // max-heap of (-load, class), so the least loaded non-approvers come first
+    best_new_approvers.clear();
+    for (int i = 0; i < is_pp_approver.size(); i++) {
+        if (!is_pp_approver[i])
+            best_new_approvers.emplace_back(-load[i], i);
+    }
+    std::ranges::make_heap(best_new_approvers);
+    long double pp_max_load_numerator = pp.cost() + loads.load_sum(pp);
+    int new_approvers_size = pp.num_of_approvers();
+    int added_from_best_class = 0;
+    do {
+        if (best_new_approvers.empty()) {
+            return {};
         }
+        auto best_new_approver = best_new_approvers.front().second;
+        pp_max_load_numerator += load[best_new_approver];
+        new_approvers_size++;
+        if (++added_from_best_class == weights[best_new_approver]) {
+            std::ranges::pop_heap(best_new_approvers);
+            best_new_approvers.pop_back();
+            added_from_best_class = 0;
+        }
+    } while (pbmath::is_greater_than(pp_max_load_numerator / new_approvers_size, min_max_load) ||
+             (pbmath::is_equal(pp_max_load_numerator / new_approvers_size, min_max_load) &&
+              (would_break ||
+               tie_breaking(winner, ProjectEmbedding(pp.cost(), pp.name(), pp.approvers(), new_approvers_size)))));
 
-        winners.push_back(winner);
-        total_budget -= winner.cost();
-        projects.erase(remove(projects.begin(), projects.end(), winner), projects.end());
+    return new_approvers_size - pp.num_of_approvers();
+}
+} // namespace
+
+std::vector<ProjectEmbedding> phragmen(const Election &election, const ProjectComparator &tie_breaking,
+                                       int num_threads, RoundLog *log) {
+    // todo: try with max_load recalculation skipping
+    std::vector<ProjectEmbedding> winners;
+    if (log) {
+        log->clear();
+    }
+
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+
+    PhragmenLoads loads(election, workspace);
+    PhragmenRounds rounds(election, loads, tie_breaking, workspace, {}, num_threads);
+    while (auto winner = rounds.next_winner()) {
+        rounds.select(*winner, log);
+        winners.push_back(election.projects()[winner->index]);
     }
     return winners;
 }
 
 long long cost_reduction_for_phragmen(const Election &election, int p, const ProjectComparator &tie_breaking) {
     auto total_budget = election.budget();
-    auto n_voters = election.num_of_voters();
-    auto projects = election.projects();
-    std::vector<long double> load(n_voters, 0);
+    const auto &pp = election.projects()[p];
+
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
 
-    auto pp = projects[p];
+    auto projects = remaining_projects(election, workspace);
+    auto round_winners = workspace.reserved<const ProjectEmbedding *>(projects.size());
+    PhragmenLoads loads(election, workspace);
     long long max_price_to_be_chosen = 0;
 
-    while (!projects.empty()) {
+    while (!projects.empty() && !cancellation::requested()) {
         long double min_max_load = std::numeric_limits<long double>::max();
-        std::vector<ProjectEmbedding> round_winners;
-        for (const auto &project : projects) {
-            long double max_load = project.cost();
-            if (project.num_of_approvers() == 0) {
-                max_load = std::numeric_limits<long double>::max();
-            } else {
-                for (const auto &approver : project.approvers())
-                    max_load += load[approver];
-                max_load /= project.num_of_approvers();
-            }
+        round_winners.clear();
+        for (const auto *project : projects) {
+            long double max_load = loads.max_load(*project);
 
             if (pbmath::is_less_than(max_load, min_max_load)) {
                 round_winners.clear();
@@ -96,75 +189,64 @@ long long cost_reduction_for_phragmen(const Election &election, int p, const Pro
             }
         }
 
-        bool would_break =
-            any_of(round_winners.begin(), round_winners.end(),
-                   [total_budget](const ProjectEmbedding &winner) { return winner.cost() > total_budget; });
-        bool would_break_without_pp =
-            any_of(round_winners.begin(), round_winners.end(), [total_budget, &pp](const ProjectEmbedding &winner) {
-                return winner.cost() > total_budget && !(winner == pp);
-            });
+        bool would_break = std::ranges::any_of(
+            round_winners, [total_budget](const auto *winner) { return winner->cost() > total_budget; });
+        bool would_break_without_pp = std::ranges::any_of(round_winners, [total_budget, &pp](const auto *winner) {
+            return winner->cost() > total_budget && !(*winner == pp);
+        });
 
-        const auto &winner = *std::ranges::min_element(round_winners, tie_breaking);
+        const auto &winner = round_winner(round_winners, tie_breaking);
 
         if (pp.num_of_approvers() == 0) {
             if (winner.num_of_approvers() == 0 && !would_break_without_pp) {
-                int new_p = std::ranges::find(round_winners, pp) - round_winners.begin();
-                auto new_election = Election(total_budget, round_winners.size(), round_winners);
-                return cost_reduction_for_greedy(new_election, new_p, tie_breaking);
+                return max_price_among_unapproved(round_winners, pp, total_budget, tie_breaking);
             }
         } else {
-            long double load_sum = 0;
-            for (const auto &approver : pp.approvers()) {
-                load_sum += load[approver];
-            }
-            long long curr_max_price = pbmath::floor(min_max_load * pp.num_of_approvers() - load_sum);
-            curr_max_price = std::min({curr_max_price, pp.cost(), total_budget});
-            long double pp_max_load = (curr_max_price + load_sum) / pp.num_of_approvers();
-
-            if (pbmath::is_equal(pp_max_load, min_max_load) &&
-                (would_break_without_pp ||
-                 tie_breaking(winner, ProjectEmbedding(curr_max_price, pp.name(), pp.approvers())))) {
-                curr_max_price--;
-            }
-            max_price_to_be_chosen = std::max(max_price_to_be_chosen, curr_max_price);
+            max_price_to_be_chosen =
+                std::max(max_price_to_be_chosen, price_in_round(pp, loads, min_max_load, total_budget, winner,
+                                                                would_break_without_pp, tie_breaking));
         }
 
         if (would_break) {
             break;
         }
 
-        for (const auto &approver : winner.approvers()) {
-            load[approver] = min_max_load;
-        }
+        loads.select(winner, min_max_load);
 
         total_budget -= winner.cost();
-        projects.erase(remove(projects.begin(), projects.end(), winner), projects.end());
+        projects.erase(std::ranges::find(projects, &winner));
     }
     return max_price_to_be_chosen;
 }
 
 std::optional<int> optimist_add_for_phragmen(const Election &election, int p, const ProjectComparator &tie_breaking) {
     auto total_budget = election.budget();
-    auto n_voters = election.num_of_voters();
-    auto projects = election.projects();
-    std::vector<long double> load(n_voters, 0);
-
-    auto pp = projects[p];
-    std::unordered_set<int> pp_approvers(pp.approvers().begin(), pp.approvers().end());
+    auto n_classes = election.num_of_voter_classes();
+    const auto &weights = election.voter_weights();
+    const auto &pp = election.projects()[p];
+
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+
+    auto projects = remaining_projects(election, workspace);
+    auto round_winners = workspace.reserved<const ProjectEmbedding *>(projects.size());
+    PhragmenLoads loads(election, workspace);
+    std::pmr::vector<bool> is_pp_approver(n_classes, false, &workspace);
+    for (const auto &approver : pp.approvers()) {
+        is_pp_approver[approver] = true;
+    }
+    auto best_new_approvers = workspace.reserved<std::pair<long double, int>>(n_classes);
     std::optional<int> result{};
 
-    while (!projects.empty()) {
+    while (!projects.empty() && !cancellation::requested()) {
+        if (pp.cost() > total_budget) { // checked before the scan, which would be wasted on the last round
+            break;
+        }
+
         long double min_max_load = std::numeric_limits<long double>::max();
-        std::vector<ProjectEmbedding> round_winners;
-        for (const auto &project : projects) {
-            long double max_load = project.cost();
-            if (project.num_of_approvers() == 0) {
-                max_load = std::numeric_limits<long double>::max();
-            } else {
-                for (const auto &approver : project.approvers())
-                    max_load += load[approver];
-                max_load /= project.num_of_approvers();
-            }
+        round_winners.clear();
+        for (const auto *project : projects) {
+            long double max_load = loads.max_load(*project);
 
             if (pbmath::is_less_than(max_load, min_max_load)) {
                 round_winners.clear();
@@ -175,64 +257,118 @@ std::optional<int> optimist_add_for_phragmen(const Election &election, int p, co
             }
         }
 
-        if (pp.cost() > total_budget)
-            break;
+        bool would_break = std::ranges::any_of(
+            round_winners, [total_budget](const auto *winner) { return winner->cost() > total_budget; });
 
-        bool would_break =
-            any_of(round_winners.begin(), round_winners.end(),
-                   [total_budget](const ProjectEmbedding &winner) { return winner.cost() > total_budget; });
-
-        const auto &winner = *std::ranges::min_element(round_winners, tie_breaking);
+        const auto &winner = round_winner(round_winners, tie_breaking);
 
         if (winner == pp && !would_break)
             return 0;
 
-        std::priority_queue<std::pair<long double, int>> best_new_approvers;
-        for (int i = 0; i < n_voters; i++) {
-            if (pp_approvers.find(i) == pp_approvers.end())
-                best_new_approvers.push({-load[i], i});
+        if (auto added = approvers_to_win_round(pp, loads, weights, is_pp_approver, best_new_approvers, min_max_load,
+                                                winner, would_break, tie_breaking)) {
+            result = pbmath::optional_min(result, *added);
+        }
+
+        if (would_break) {
+            break;
+        }
+
+        loads.select(winner, min_max_load);
+
+        total_budget -= winner.cost();
+        projects.erase(std::ranges::find(projects, &winner));
+    }
+    return result;
+}
+
+std::vector<SensitivityPoint> sensitivity_curve_for_phragmen(const Election &election, int p,
+                                                             const ProjectComparator &tie_breaking) {
+    auto total_budget = election.budget();
+    auto n_classes = election.num_of_voter_classes();
+    const auto &weights = election.voter_weights();
+    const auto &pp = election.projects()[p];
+
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+
+    auto projects = remaining_projects(election, workspace);
+    auto round_winners = workspace.reserved<const ProjectEmbedding *>(projects.size());
+    PhragmenLoads loads(election, workspace);
+    std::pmr::vector<bool> is_pp_approver(n_classes, false, &workspace);
+    for (const auto &approver : pp.approvers()) {
+        is_pp_approver[approver] = true;
+    }
+    auto best_new_approvers = workspace.reserved<std::pair<long double, int>>(n_classes);
+    std::vector<SensitivityPoint> curve;
+    bool priced = false; // a project without approvers gets its price once, from GreedyAV over the tied projects
+
+    while (!projects.empty() && !cancellation::requested()) {
+        long double min_max_load = std::numeric_limits<long double>::max();
+        round_winners.clear();
+        for (const auto *project : projects) {
+            long double max_load = loads.max_load(*project);
+
+            if (pbmath::is_less_than(max_load, min_max_load)) {
+                round_winners.clear();
+                min_max_load = max_load;
+            }
+            if (pbmath::is_equal(max_load, min_max_load)) {
+                round_winners.push_back(project);
+            }
         }
-        long double pp_max_load_numerator = pp.cost();
-        for (const auto &approver : pp.approvers()) {
-            pp_max_load_numerator += load[approver];
+
+        bool would_break = std::ranges::any_of(
+            round_winners, [total_budget](const auto *winner) { return winner->cost() > total_budget; });
+        bool would_break_without_pp = std::ranges::any_of(round_winners, [total_budget, &pp](const auto *winner) {
+            return winner->cost() > total_budget && !(*winner == pp);
+        });
+
+        const auto &winner = round_winner(round_winners, tie_breaking);
+        int winner_index = &winner - election.projects().data();
+
+        if (winner == pp && !would_break) {
+            curve.push_back({p, pp.cost(), 0});
+            break;
         }
-        auto new_approvers = pp.approvers();
-        bool enough_approvers = true;
-        do {
-            if (best_new_approvers.empty()) {
-                enough_approvers = false;
-                break;
+
+        SensitivityPoint point{winner_index, 0, std::nullopt};
+
+        // price at which pp would be selected in this round
+        if (pp.num_of_approvers() == 0) {
+            if (!priced && winner.num_of_approvers() == 0 && !would_break_without_pp) {
+                point.price = max_price_among_unapproved(round_winners, pp, total_budget, tie_breaking);
+                priced = true;
             }
-            pp_max_load_numerator += load[best_new_approvers.top().second];
-            best_new_approvers.pop();
-            new_approvers.push_back(best_new_approvers.top().second);
-        } while (pbmath::is_greater_than(pp_max_load_numerator / new_approvers.size(), min_max_load) ||
-                 (pbmath::is_equal(pp_max_load_numerator / new_approvers.size(), min_max_load) &&
-                  (would_break || tie_breaking(winner, ProjectEmbedding(pp.cost(), pp.name(), new_approvers)))));
-
-        if (enough_approvers) {
-            result = pbmath::optional_min(result, static_cast<int>(new_approvers.size() - pp.num_of_approvers()));
+        } else {
+            point.price = std::max(0LL, price_in_round(pp, loads, min_max_load, total_budget, winner,
+                                                       would_break_without_pp, tie_breaking));
+        }
+
+        // approvals pp would need to be selected in this round
+        if (pp.cost() <= total_budget) {
+            point.added_approvers = approvers_to_win_round(pp, loads, weights, is_pp_approver, best_new_approvers,
+                                                           min_max_load, winner, would_break, tie_breaking);
         }
 
+        curve.push_back(point);
+
         if (would_break) {
             break;
         }
 
-        for (const auto &approver : winner.approvers()) {
-            load[approver] = min_max_load;
-        }
+        loads.select(winner, min_max_load);
 
         total_budget -= winner.cost();
-        projects.erase(remove(projects.begin(), projects.end(), winner), projects.end());
+        projects.erase(std::ranges::find(projects, &winner));
     }
-    return result;
+    return curve;
 }
 
 std::optional<int> pessimist_add_for_phragmen(const Election &election, int p, const ProjectComparator &tie_breaking) {
     auto total_budget = election.budget();
     auto n_voters = election.num_of_voters();
-    auto projects = election.projects();
-    auto pp = projects[p];
+    const auto &pp = election.projects()[p];
 
     auto allocation = phragmen(election, tie_breaking);
     if (std::ranges::find(allocation, pp) != allocation.end()) {
@@ -242,28 +378,29 @@ std::optional<int> pessimist_add_for_phragmen(const Election &election, int p, c
     const auto voter_types = calculate_voter_types(election, p, allocation);
     int t = voter_types.size();
 
-    std::unique_ptr<MPSolver> solver(MPSolver::CreateSolver("SCIP"));
-    std::vector<const MPVariable *> x_T;
-    x_T.reserve(t);
-    for (int j = 0; j < t; j++) {
-        auto voter_type_count = voter_types[j].first;
-        x_T.push_back(solver->MakeIntVar(0, voter_type_count, "x_T_" + std::to_string(j)));
+    std::vector<int> voter_type_counts;
+    for (const auto &voter_type : voter_types) {
+        voter_type_counts.push_back(voter_type.first);
     }
+    PessimistModel model(std::move(voter_type_counts));
 
-    std::vector<long double> load(n_voters, 0);
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+
+    auto projects = remaining_projects(election, workspace);
+    auto round_winners = workspace.reserved<const ProjectEmbedding *>(projects.size());
+    PhragmenLoads loads(election, workspace);
+    const auto &load = loads.load();
+
+    while (!projects.empty() && !cancellation::requested()) {
+        if (pp.cost() > total_budget) { // checked before the scan, which would be wasted on the last round
+            break;
+        }
 
-    while (!projects.empty()) {
         long double min_max_load = std::numeric_limits<long double>::max();
-        std::vector<ProjectEmbedding> round_winners;
-        for (const auto &project : projects) {
-            long double max_load = project.cost();
-            if (project.num_of_approvers() == 0) {
-                max_load = std::numeric_limits<long double>::max();
-            } else {
-                for (const auto &approver : project.approvers())
-                    max_load += load[approver];
-                max_load /= project.num_of_approvers();
-            }
+        round_winners.clear();
+        for (const auto *project : projects) {
+            long double max_load = loads.max_load(*project);
 
             if (pbmath::is_less_than(max_load, min_max_load)) {
                 round_winners.clear();
@@ -274,15 +411,10 @@ std::optional<int> pessimist_add_for_phragmen(const Election &election, int p, c
             }
         }
 
-        if (pp.cost() > total_budget) {
-            break;
-        }
-
-        bool would_break =
-            any_of(round_winners.begin(), round_winners.end(),
-                   [total_budget](const ProjectEmbedding &winner) { return winner.cost() > total_budget; });
+        bool would_break = std::ranges::any_of(
+            round_winners, [total_budget](const auto *winner) { return winner->cost() > total_budget; });
 
-        const auto &winner = *std::ranges::min_element(round_winners, tie_breaking);
+        const auto &winner = round_winner(round_winners, tie_breaking);
 
         { // ILP reduction constraints
             if (min_max_load == std::numeric_limits<long double>::max()) {
@@ -290,9 +422,7 @@ std::optional<int> pessimist_add_for_phragmen(const Election &election, int p, c
                 // it's enough to add one more approver
                 return 1;
             }
-            long double pp_max_load_numerator = pp.cost();
-            for (const auto &approver : pp.approvers())
-                pp_max_load_numerator += load[approver];
+            long double pp_max_load_numerator = pp.cost() + loads.load_sum(pp);
             long double pp_max_load_denominator = pp.num_of_approvers();
             long double m_i = pp_max_load_numerator - min_max_load * pp_max_load_denominator;
             // todo: what if tie-breaking depends on the number of votes?
@@ -300,62 +430,52 @@ std::optional<int> pessimist_add_for_phragmen(const Election &election, int p, c
                 // we need a strict inequality; the solver's default precision is 1e-6, so need to exceed that
                 m_i = std::min(m_i - 1e-5, m_i * (1 - 1e-5));
             }
-            MPConstraint *const c = solver->MakeRowConstraint(-solver->infinity(), m_i);
+            std::vector<double> coefficients(t);
             for (int j = 0; j < t; j++) {
                 auto voter_type_example = voter_types[j].second;
-                c->SetCoefficient(x_T[j], min_max_load - load[voter_type_example]);
+                coefficients[j] = min_max_load - load[voter_type_example];
             }
+            model.add_round();
+            model.add_row(-std::numeric_limits<double>::infinity(), m_i, std::move(coefficients));
         }
 
         if (would_break)
             break;
 
-        for (const auto &approver : winner.approvers()) {
-            load[approver] = min_max_load;
-        }
+        loads.select(winner, min_max_load);
 
         total_budget -= winner.cost();
-        projects.erase(remove(projects.begin(), projects.end(), winner), projects.end());
+        projects.erase(std::ranges::find(projects, &winner));
     }
 
-    MPObjective *const objective = solver->MutableObjective();
-    for (int j = 0; j < t; j++) {
-        objective->SetCoefficient(x_T[j], 1);
-    }
-    objective->SetMaximization();
-
-    MPSolver::ResultStatus result_status = solver->Solve();
-    if (result_status == MPSolver::OPTIMAL) {
-        // MIP solver might return something like 1.99999999, so we add 0.1 to be safe
-        int result = objective->Value() + 0.1;
-        if (result + 1 + pp.num_of_approvers() <= n_voters) {
-            return result + 1;
-        }
+    auto result = model.maximize();
+    if (result && *result + 1 + pp.num_of_approvers() <= n_voters) {
+        return *result + 1;
     }
     return {};
 }
 
 std::optional<int> singleton_add_for_phragmen(const Election &election, int p, const ProjectComparator &tie_breaking) {
     auto total_budget = election.budget();
-    auto n_voters = election.num_of_voters();
-    auto projects = election.projects();
-    std::vector<long double> load(n_voters, 0);
+    const auto &pp = election.projects()[p];
+
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
 
-    auto pp = projects[p];
+    auto projects = remaining_projects(election, workspace);
+    auto round_winners = workspace.reserved<const ProjectEmbedding *>(projects.size());
+    PhragmenLoads loads(election, workspace);
     std::optional<int> result{};
 
-    while (!projects.empty()) {
+    while (!projects.empty() && !cancellation::requested()) {
+        if (pp.cost() > total_budget) { // checked before the scan, which would be wasted on the last round
+            break;
+        }
+
         long double min_max_load = std::numeric_limits<long double>::max();
-        std::vector<ProjectEmbedding> round_winners;
-        for (const auto &project : projects) {
-            long double max_load = project.cost();
-            if (project.num_of_approvers() == 0) {
-                max_load = std::numeric_limits<long double>::max();
-            } else {
-                for (const auto &approver : project.approvers())
-                    max_load += load[approver];
-                max_load /= project.num_of_approvers();
-            }
+        round_winners.clear();
+        for (const auto *project : projects) {
+            long double max_load = loads.max_load(*project);
 
             if (pbmath::is_less_than(max_load, min_max_load)) {
                 round_winners.clear();
@@ -366,28 +486,20 @@ std::optional<int> singleton_add_for_phragmen(const Election &election, int p, c
             }
         }
 
-        if (pp.cost() > total_budget)
-            break;
+        bool would_break = std::ranges::any_of(
+            round_winners, [total_budget](const auto *winner) { return winner->cost() > total_budget; });
 
-        bool would_break =
-            any_of(round_winners.begin(), round_winners.end(),
-                   [total_budget](const ProjectEmbedding &winner) { return winner.cost() > total_budget; });
-
-        const auto &winner = *std::ranges::min_element(round_winners, tie_breaking);
+        const auto &winner = round_winner(round_winners, tie_breaking);
 
         if (winner == pp && !would_break)
             return 0;
-        long double pp_max_load_numerator = pp.cost();
-        for (const auto &approver : pp.approvers()) {
-            pp_max_load_numerator += load[approver];
-        }
+        long double pp_max_load_numerator = pp.cost() + loads.load_sum(pp);
         int new_approvers_size = pbmath::ceil(pp_max_load_numerator / min_max_load);
-        std::vector<int> new_approvers(new_approvers_size);
-        std::iota(new_approvers.begin(), new_approvers.end(), 0);
         auto pp_max_load = new_approvers_size == 0 ? std::numeric_limits<long double>::max()
                                                    : pp_max_load_numerator / new_approvers_size;
         if (pbmath::is_equal(min_max_load, pp_max_load) &&
-            (would_break || tie_breaking(winner, ProjectEmbedding(pp.cost(), pp.name(), new_approvers)))) {
+            (would_break ||
+             tie_breaking(winner, ProjectEmbedding(pp.cost(), pp.name(), pp.approvers(), new_approvers_size)))) {
             new_approvers_size += 1;
         }
 
@@ -397,12 +509,10 @@ std::optional<int> singleton_add_for_phragmen(const Election &election, int p, c
             break;
         }
 
-        for (const auto &approver : winner.approvers()) {
-            load[approver] = min_max_load;
-        }
+        loads.select(winner, min_max_load);
 
         total_budget -= winner.cost();
-        projects.erase(remove(projects.begin(), projects.end(), winner), projects.end());
+        projects.erase(std::ranges::find(projects, &winner));
     }
     return result;
 }
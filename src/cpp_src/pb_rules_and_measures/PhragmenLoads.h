@@ -0,0 +1,178 @@
+#pragma once
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/Math.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/RoundLog.h"
+#include "utils/ThreadPool.h"
+#include "utils/Workspace.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace phragmen_detail {
+// Loads of the voter classes, with the total load of the approvers of every project kept up to date. A voter class to
+// approved projects index is built once; a round then only pushes the load changes of the winner's approvers to the
+// projects they approve, so it costs O(approvals of the winner's approvers) instead of O(all approvals).
+class PhragmenLoads {
+  public:
+    PhragmenLoads(const Election &election, Workspace &workspace)
+        : projects_(election.projects()), weights_(election.voter_weights()),
+          load_(election.num_of_voter_classes(), 0, &workspace), load_sum_(projects_.size(), 0, &workspace),
+          approved_begin_(election.num_of_voter_classes() + 1, 0, &workspace), approved_(&workspace) {
+        for (const auto &project : projects_) {
+            for (const auto &approver : project.approvers()) {
+                approved_begin_[approver + 1]++;
+            }
+        }
+        std::partial_sum(approved_begin_.begin(), approved_begin_.end(), approved_begin_.begin());
+        approved_.resize(approved_begin_.back());
+        auto next = workspace.reserved<int>(approved_begin_.size());
+        next.assign(approved_begin_.begin(), approved_begin_.end());
+        for (int i = 0; i < projects_.size(); i++) {
+            for (const auto &approver : projects_[i].approvers()) {
+                approved_[next[approver]++] = i;
+            }
+        }
+    }
+
+    // Current load of every voter class.
+    const std::pmr::vector<long double> &load() const { return load_; }
+
+    // Total load of the voters approving the project.
+    long double load_sum(const ProjectEmbedding &project) const { return load_sum_[&project - projects_.data()]; }
+
+    // Load of every approver if the project was selected now, the maximal value if it has no approvers.
+    long double max_load(const ProjectEmbedding &project) const {
+        if (project.num_of_approvers() == 0) {
+            return std::numeric_limits<long double>::max();
+        }
+        return (project.cost() + load_sum(project)) / project.num_of_approvers();
+    }
+
+    // Selects the winner of a round: the load of all its approvers becomes new_load. The round and the load taken on by
+    // every approver are recorded in log, if given.
+    void select(const ProjectEmbedding &winner, long double new_load, RoundLog *log = nullptr) {
+        if (log) {
+            log->add_round(&winner - projects_.data(), new_load);
+        }
+        for (const auto &approver : winner.approvers()) {
+            if (log) {
+                log->add_payment(approver, new_load - load_[approver]);
+            }
+            long double change = weights_[approver] * (new_load - load_[approver]);
+            load_[approver] = new_load;
+            for (int i = approved_begin_[approver]; i < approved_begin_[approver + 1]; i++) {
+                load_sum_[approved_[i]] += change;
+            }
+        }
+    }
+
+  private:
+    const std::vector<ProjectEmbedding> &projects_;
+    const std::vector<int> &weights_;
+    std::pmr::vector<long double> load_, load_sum_;
+    // projects approved by class c: approved_[approved_begin_[c]], ..., approved_[approved_begin_[c + 1] - 1]
+    std::pmr::vector<int> approved_begin_, approved_;
+};
+
+// Winner of a round of Phragmén (indices into election.projects()).
+struct PhragmenRoundWinner {
+    int index;
+    long double new_load;
+    int price_setter; // the first project whose max load became new_load, tied with the winner
+};
+
+// The rounds of Phragmén: a round selects, among the remaining projects, one with the least max load, ties within EPS
+// broken by tie_breaking, and the rounds stop once a tied project is unaffordable. The max loads are computed in
+// parallel, then reduced sequentially in the original order.
+//
+// The rounds resume after the given winners (indices into election.projects()), which loads must already have selected,
+// e.g. replayed from checkpoints. Containers live in the given workspace, so the rounds must not outlive its scope.
+class PhragmenRounds {
+  public:
+    PhragmenRounds(const Election &election, PhragmenLoads &loads, const ProjectComparator &tie_breaking,
+                   Workspace &workspace, std::span<const int> winners = {}, int num_threads = 1)
+        : projects_(election.projects()), loads_(loads), tie_breaking_(tie_breaking),
+          remaining_(workspace.reserved<int>(projects_.size())),
+          round_winners_(workspace.reserved<int>(projects_.size())), max_loads_(&workspace), pool_(num_threads),
+          uniform_cost_(election.uniform_cost()), remaining_budget_(election.budget()) {
+        auto is_winner = workspace.reserved<char>(projects_.size());
+        is_winner.resize(projects_.size(), false);
+        for (int winner : winners) {
+            is_winner[winner] = true;
+            remaining_budget_ -= projects_[winner].cost();
+        }
+        for (int i = 0; i < projects_.size(); i++) {
+            if (!is_winner[i]) {
+                remaining_.push_back(i);
+            }
+        }
+    }
+
+    // Winner of the next round, or nothing once a project tied for the least max load is unaffordable (or the
+    // computation is cancelled).
+    std::optional<PhragmenRoundWinner> next_winner() {
+        if (remaining_.empty() || cancellation::requested()) {
+            return {};
+        }
+        if (uniform_cost_ && *uniform_cost_ > remaining_budget_) {
+            return {}; // every round winner would be unaffordable, no need to find them
+        }
+
+        max_loads_.resize(remaining_.size());
+        pool_.parallel_for(remaining_.size(), [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                max_loads_[i] = loads_.max_load(projects_[remaining_[i]]);
+            }
+        });
+
+        long double min_max_load = std::numeric_limits<long double>::max();
+        int price_setter = -1;
+        round_winners_.clear();
+        for (int i = 0; i < remaining_.size(); i++) {
+            if (pbmath::is_less_than(max_loads_[i], min_max_load)) {
+                round_winners_.clear();
+                min_max_load = max_loads_[i];
+                price_setter = remaining_[i];
+            }
+            if (pbmath::is_equal(max_loads_[i], min_max_load)) {
+                round_winners_.push_back(remaining_[i]);
+            }
+        }
+        if (std::ranges::any_of(round_winners_,
+                                [this](int index) { return projects_[index].cost() > remaining_budget_; })) {
+            return {};
+        }
+
+        auto project_at = [this](int index) -> const ProjectEmbedding & { return projects_[index]; };
+        int winner = *std::ranges::min_element(round_winners_, tie_breaking_, project_at);
+        return PhragmenRoundWinner{winner, min_max_load, price_setter};
+    }
+
+    // Selects the winner of the round: the load of all its approvers becomes new_load. The round and the loads are
+    // recorded in log, if given.
+    void select(const PhragmenRoundWinner &winner, RoundLog *log = nullptr) {
+        const auto &project = projects_[winner.index];
+        loads_.select(project, winner.new_load, log);
+        remaining_budget_ -= project.cost();
+        remaining_.erase(std::ranges::find(remaining_, winner.index));
+    }
+
+  private:
+    const std::vector<ProjectEmbedding> &projects_;
+    PhragmenLoads &loads_;
+    const ProjectComparator &tie_breaking_;
+    std::pmr::vector<int> remaining_, round_winners_;
+    std::pmr::vector<long double> max_loads_;
+    ThreadPool pool_;
+    std::optional<long long> uniform_cost_;
+    long long remaining_budget_;
+};
+} // namespace phragmen_detail
@@ -0,0 +1,209 @@
+#include "Recount.h"
+
+#include "MesEngine.h"
+#include "MesUtility.h"
+#include "PhragmenLoads.h"
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/Math.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/Workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+using phragmen_detail::PhragmenLoads;
+using phragmen_detail::PhragmenRounds;
+
+Recount::Recount(const Election &election, Rule rule, const ProjectComparator &tie_breaking)
+    : budget_(election.budget()), rule_(rule), tie_breaking_(tie_breaking), projects_(election.projects()),
+      ballots_(election.num_of_voter_classes()), weights_(election.voter_weights()),
+      evaluated_weights_(election.voter_weights()), changed_(election.num_of_voter_classes()) {
+    for (int i = 0; i < static_cast<int>(projects_.size()); i++) {
+        for (int approver : projects_[i].approvers()) {
+            ballots_[approver].push_back(i);
+        }
+    }
+}
+
+void Recount::mark_changed(int voter_class) {
+    if (!changed_[voter_class]) {
+        changed_[voter_class] = true;
+        changed_classes_.push_back(voter_class);
+    }
+}
+
+void Recount::set_weight(int voter_class, int weight) {
+    if (weights_[voter_class] != weight) {
+        weights_[voter_class] = weight;
+        mark_changed(voter_class);
+    }
+}
+
+int Recount::add_voter_class(const std::vector<int> &approved, int weight) {
+    int voter_class = weights_.size();
+    for (int index : approved) {
+        const auto &project = projects_[index];
+        std::vector<int> approvers(project.approvers().begin(), project.approvers().end());
+        approvers.push_back(voter_class);
+        projects_[index] = ProjectEmbedding(project.cost(), project.name(), std::move(approvers));
+    }
+    ballots_.push_back(approved);
+    weights_.push_back(weight);
+    evaluated_weights_.push_back(0);
+    changed_.push_back(false);
+    mark_changed(voter_class);
+    return voter_class;
+}
+
+const std::vector<int> &Recount::winners() {
+    // a class back at its evaluated weight (a ballot added and retracted again) changes nothing
+    std::erase_if(changed_classes_, [this](int voter_class) {
+        bool undone = weights_[voter_class] == evaluated_weights_[voter_class];
+        changed_[voter_class] = !undone;
+        return undone;
+    });
+    if (evaluated_ && changed_classes_.empty()) {
+        resumed_round_ = winners_.size();
+        return winners_;
+    }
+    Election election(budget_, weights_, projects_);
+    int round = 0;
+    switch (rule_) {
+    case Rule::MES_APR:
+        round = recount_mes<mes_detail::ApprovalUtility>(election);
+        break;
+    case Rule::MES_COST:
+        round = recount_mes<mes_detail::CostUtility>(election);
+        break;
+    case Rule::PHRAGMEN:
+        round = recount_phragmen(election);
+        break;
+    }
+
+    for (int voter_class : changed_classes_) {
+        changed_[voter_class] = false;
+    }
+    changed_classes_.clear();
+    evaluated_weights_ = weights_;
+    num_of_voters_ = election.num_of_voters();
+    evaluated_ = !cancellation::requested(); // the winners of a cancelled run are incomplete, the next call starts over
+    resumed_round_ = std::min(round, static_cast<int>(winners_.size()));
+    return winners_;
+}
+
+// The state before a round is replayed with the same code as the rules (mes_detail::pay, PhragmenLoads), and the rule
+// is resumed with the rounds of the rule itself, so a recount and a fresh run compute the same values.
+template <typename Utility> int Recount::recount_mes(const Election &election) {
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+    const auto &projects = election.projects();
+    const auto &weights = election.voter_weights();
+    std::pmr::vector<long double> budget(election.num_of_voter_classes(),
+                                         static_cast<long double>(election.budget()) / election.num_of_voters(),
+                                         &workspace);
+    auto approvers = workspace.reserved<int>(election.num_of_voter_classes());
+
+    // the voter budget depends on the number of voters, so changing it changes every round
+    int round = 0;
+    if (evaluated_ && election.num_of_voters() == num_of_voters_) {
+        round = first_round_to_rerun(
+            [&](int index) { return mes_detail::evaluate<Utility>(projects[index], budget, weights, approvers); },
+            [&](int checkpoint) {
+                mes_detail::pay<Utility>(projects[winners_[checkpoint]], prices_[checkpoint], budget);
+            });
+    }
+    if (round > static_cast<int>(winners_.size())) {
+        return round;
+    }
+    truncate(round);
+
+    mes_detail::MesRounds<Utility> rounds(election, tie_breaking_, workspace, budget, winners_);
+    while (auto winner = rounds.next_winner()) {
+        rounds.select(*winner);
+        winners_.push_back(winner->index);
+        prices_.push_back(winner->max_payment_per_utility);
+        price_setters_.push_back(winner->index);
+    }
+    return round;
+}
+
+int Recount::recount_phragmen(const Election &election) {
+    Workspace::Scope scope;
+    auto &workspace = scope.workspace();
+    const auto &projects = election.projects();
+    PhragmenLoads loads(election, workspace);
+
+    int round = 0;
+    if (evaluated_) {
+        round = first_round_to_rerun(
+            [&](int index) -> std::optional<long double> { return loads.max_load(projects[index]); },
+            [&](int checkpoint) { loads.select(projects[winners_[checkpoint]], prices_[checkpoint]); });
+    }
+    if (round > static_cast<int>(winners_.size())) {
+        return round;
+    }
+    truncate(round);
+
+    PhragmenRounds rounds(election, loads, tie_breaking_, workspace, winners_);
+    while (auto winner = rounds.next_winner()) {
+        rounds.select(*winner);
+        winners_.push_back(winner->index);
+        prices_.push_back(winner->new_load);
+        price_setters_.push_back(winner->price_setter);
+    }
+    return round;
+}
+
+// Replays the checkpoints with select_round for as long as no edited project could change a decision, where value is
+// the value of a project in the replayed state: the max payment per unit of utility for MES (nothing if unaffordable),
+// the max load for Phragmén. A round keeps its decision if its winner (and, for Phragmén, the project that set its
+// price) is not edited and no edited project comes within EPS of its price; the round after the last one is rerun
+// whenever an edited project is left, as it may now be affordable (or, for Phragmén, unaffordable). Returns the first
+// round to rerun, the number of rounds + 1 if the previous outcome stands as is.
+int Recount::first_round_to_rerun(const std::function<std::optional<long double>(int)> &value,
+                                  const std::function<void(int)> &select_round) const {
+    std::vector<char> edited(projects_.size()), selected(projects_.size());
+    for (int voter_class : changed_classes_) {
+        for (int index : ballots_[voter_class]) {
+            edited[index] = true;
+        }
+    }
+    std::vector<int> edited_projects;
+    for (int i = 0; i < static_cast<int>(projects_.size()); i++) {
+        if (edited[i]) {
+            edited_projects.push_back(i);
+        }
+    }
+
+    int n_rounds = winners_.size();
+    for (int round = 0; round < n_rounds; round++) {
+        int winner = winners_[round];
+        if (edited[winner] || (rule_ == Rule::PHRAGMEN && edited[price_setters_[round]])) {
+            return round;
+        }
+        for (int index : edited_projects) {
+            if (selected[index]) {
+                continue; // LCOV_EXCL_LINE (edited winners stop the replay)
+            }
+            auto project_value = value(index);
+            if (project_value && !pbmath::is_greater_than(*project_value, prices_[round])) {
+                return round;
+            }
+        }
+        select_round(round);
+        selected[winner] = true;
+    }
+    return edited_projects.empty() ? n_rounds + 1 : n_rounds;
+}
+
+// Drops the checkpoints from the given round on.
+void Recount::truncate(int round) {
+    winners_.resize(round);
+    prices_.resize(round);
+    price_setters_.resize(round);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+// Outcome of MES or Phragmén kept up to date while ballots change. Every round is checkpointed by its winner and price
+// (the max payment per unit of utility of the winner for MES, the new load of its approvers for Phragmén); the state
+// before a round is rebuilt by replaying these. After an edit, only the projects approved by the edited voter classes
+// can change a decision, so each round is validated by evaluating just those, and the rule resumes from the first
+// round whose decision could change.
+//
+// The voter budget of MES depends on the number of voters, so for MES, edits that change it (any added or retracted
+// ballot not balanced by another before the recount) restart from round one.
+class Recount {
+  public:
+    enum class Rule { MES_APR, MES_COST, PHRAGMEN };
+
+    Recount(const Election &election, Rule rule, const ProjectComparator &tie_breaking);
+
+    // Sets the number of voters with the ballot of the voter class.
+    void set_weight(int voter_class, int weight);
+    // Adds a voter class for a new ballot (approved are indices into election.projects()) and returns its index.
+    int add_voter_class(const std::vector<int> &approved, int weight);
+
+    // Indices of the winners for the current ballots, in order of selection.
+    const std::vector<int> &winners();
+    // Round from which the last call of winners() had to re-run the rule (the number of rounds if none).
+    int resumed_round() const { return resumed_round_; }
+
+  private:
+    long long budget_;
+    Rule rule_;
+    ProjectComparator tie_breaking_;
+    std::vector<ProjectEmbedding> projects_;
+    std::vector<std::vector<int>> ballots_; // projects approved by each voter class
+    std::vector<int> weights_;
+    std::vector<int> evaluated_weights_; // at the last evaluation
+
+    // checkpoints of the last evaluation
+    std::vector<int> winners_;
+    std::vector<long double> prices_;
+    std::vector<int> price_setters_; // Phragmén: project whose max load became the price of the round
+    int num_of_voters_ = 0;          // at the last evaluation
+    bool evaluated_ = false;
+    int resumed_round_ = 0;
+
+    std::vector<char> changed_; // voter classes edited since the last evaluation
+    std::vector<int> changed_classes_;
+
+    void mark_changed(int voter_class);
+    // Re-run the rule from the first round whose decision the edits could change, and return that round.
+    template <typename Utility> int recount_mes(const Election &election);
+    int recount_phragmen(const Election &election);
+    int first_round_to_rerun(const std::function<std::optional<long double>(int)> &value,
+                             const std::function<void(int)> &select_round) const;
+    void truncate(int round);
+};
@@ -0,0 +1,111 @@
+#include "Robustness.h"
+
+#include "Greedy.h"
+#include "GreedyOverCost.h"
+#include "MesApr.h"
+#include "MesCost.h"
+#include "Phragmen.h"
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+std::vector<ProjectEmbedding> run_rule(SampledRule rule, const Election &election,
+                                       const ProjectComparator &tie_breaking) {
+    switch (rule) {
+    case SampledRule::GREEDY:
+        return greedy(election, tie_breaking);
+    case SampledRule::GREEDY_OVER_COST:
+        return greedy_over_cost(election, tie_breaking);
+    case SampledRule::MES_APR:
+        return mes_apr(election, tie_breaking);
+    case SampledRule::MES_COST:
+        return mes_cost(election, tie_breaking);
+    case SampledRule::PHRAGMEN:
+        return phragmen(election, tie_breaking);
+    }
+    return {}; // LCOV_EXCL_LINE (all rules are handled above)
+}
+
+// Number of voters of every class in a sample. Bootstrap draws the classes of the new voters one class at a time, as a
+// sequence of binomials, which is O(number of classes) instead of O(number of voters).
+void resample(const std::vector<int> &weights, int num_of_voters, Resampling resampling, double drop_fraction,
+              std::mt19937_64 &rng, std::vector<int> &sample) {
+    sample.resize(weights.size());
+    if (resampling == Resampling::DROP) {
+        for (int i = 0; i < static_cast<int>(weights.size()); i++) {
+            sample[i] = std::binomial_distribution<int>(weights[i], 1 - drop_fraction)(rng);
+        }
+        return;
+    }
+    int voters_left = num_of_voters, weight_left = num_of_voters;
+    for (int i = 0; i < static_cast<int>(weights.size()); i++) {
+        if (voters_left == 0 || weight_left == 0) {
+            sample[i] = 0;
+            continue;
+        }
+        double probability = std::min(1.0, static_cast<double>(weights[i]) / weight_left);
+        sample[i] = std::binomial_distribution<int>(voters_left, probability)(rng);
+        voters_left -= sample[i];
+        weight_left -= weights[i];
+    }
+}
+} // namespace
+
+std::vector<double> selection_frequencies(const Election &election, SampledRule rule, Resampling resampling,
+                                          double drop_fraction, int num_samples, unsigned long long seed,
+                                          const ProjectComparator &tie_breaking, int num_threads) {
+    const auto &projects = election.projects();
+    std::unordered_map<std::string_view, int> index_of;
+    index_of.reserve(projects.size());
+    for (int i = 0; i < static_cast<int>(projects.size()); i++) {
+        index_of.emplace(projects[i].name(), i);
+    }
+
+    // samples are handed out one at a time, so threads stay busy even though rule runs take different times
+    ThreadPool pool(num_threads);
+    std::atomic<int> next_sample = 0;
+    std::vector<std::vector<long long>> selections(pool.size(), std::vector<long long>(projects.size()));
+    const auto *cancelled = cancellation::flag(); // the caller's, which the pool's threads do not have
+    pool.parallel_for(pool.size(), [&](int begin, int end) {
+        cancellation::Scope cancellable(cancelled);
+        for (int worker = begin; worker < end; worker++) {
+            Election sampled = election; // the only copy of the projects, reused for all samples of this worker
+            std::vector<int> sample;
+            for (int s = next_sample++; s < num_samples && !cancellation::requested(); s = next_sample++) {
+                std::seed_seq seed_sequence{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                                            static_cast<std::uint32_t>(s)};
+                std::mt19937_64 rng(seed_sequence);
+                resample(election.voter_weights(), election.num_of_voters(), resampling, drop_fraction, rng, sample);
+                sampled.set_voter_weights(sample);
+                if (sampled.num_of_voters() == 0) {
+                    continue;
+                }
+                for (const auto &winner : run_rule(rule, sampled, tie_breaking)) {
+                    selections[worker][index_of.at(winner.name())]++;
+                }
+            }
+        }
+    });
+
+    std::vector<double> frequencies(projects.size());
+    for (const auto &worker_selections : selections) {
+        for (int i = 0; i < static_cast<int>(projects.size()); i++) {
+            frequencies[i] += worker_selections[i];
+        }
+    }
+    for (auto &frequency : frequencies) {
+        frequency /= num_samples;
+    }
+    return frequencies;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+
+#include <vector>
+
+enum class SampledRule { GREEDY, GREEDY_OVER_COST, MES_APR, MES_COST, PHRAGMEN };
+
+// BOOTSTRAP draws as many voters as the election has, with replacement; DROP removes every voter independently with
+// probability drop_fraction.
+enum class Resampling { BOOTSTRAP, DROP };
+
+// Fraction of num_samples resampled elections in which each project of the election is selected by the rule.
+// Samples only change the number of voters in each voter class, so ballots are never copied; they are spread over
+// num_threads threads (0 means all hardware threads), each rerunning the rule on its own reweighted election.
+// Every sample has its own random generator derived from seed and the index of the sample, so the result does not
+// depend on num_threads. Samples without voters select nothing.
+std::vector<double> selection_frequencies(const Election &election, SampledRule rule, Resampling resampling,
+                                          double drop_fraction, int num_samples, unsigned long long seed,
+                                          const ProjectComparator &tie_breaking, int num_threads = 1);
@@ -0,0 +1,180 @@
+#include "Sweep.h"
+
+#include "MesBudgetIncrementer.h"
+#include "PhragmenLoads.h"
+#include "utils/Cancellation.h"
+#include "utils/Election.h"
+#include "utils/Math.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/Workspace.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+namespace {
+// Positions of the budgets from the smallest to the largest budget.
+std::vector<int> increasing_order(const std::vector<long long> &budgets) {
+    std::vector<int> order(budgets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, {}, [&budgets](int i) { return budgets[i]; });
+    return order;
+}
+
+// Takes the projects in the order of the ranking whenever they still fit, for every budget. Raising the budget of a
+// scan by less than the smallest amount missing for a rejected project to fit changes no decision, so the scan is only
+// repeated at budgets beyond that breakpoint.
+std::vector<std::vector<int>> greedy_scan_sweep(const std::vector<ProjectEmbedding> &projects,
+                                                const std::vector<int> &ranking,
+                                                const std::vector<long long> &budgets) {
+    std::vector<std::vector<int>> allocations(budgets.size());
+    std::vector<int> allocation;
+    std::optional<long long> next_breakpoint;
+    for (int i : increasing_order(budgets)) {
+        if (!next_breakpoint || budgets[i] >= *next_breakpoint) {
+            allocation.clear();
+            long long remaining_budget = budgets[i];
+            long long smallest_missing = std::numeric_limits<long long>::max();
+            for (int index : ranking) {
+                if (projects[index].cost() <= remaining_budget) {
+                    allocation.push_back(index);
+                    remaining_budget -= projects[index].cost();
+                } else {
+                    smallest_missing = std::min(smallest_missing, projects[index].cost() - remaining_budget);
+                }
+            }
+            next_breakpoint = smallest_missing == std::numeric_limits<long long>::max()
+                                  ? std::numeric_limits<long long>::max()
+                                  : budgets[i] + smallest_missing;
+        }
+        allocations[i] = allocation;
+    }
+    return allocations;
+}
+
+template <typename Utility>
+std::vector<std::vector<int>> mes_sweep(const Election &election, const std::vector<long long> &budgets,
+                                        const ProjectComparator &tie_breaking) {
+    auto n_voters = election.num_of_voters();
+    mes_detail::MesBudgetIncrementer<Utility> engine(election, tie_breaking);
+
+    std::vector<std::vector<int>> allocations(budgets.size());
+    std::vector<int> allocation;
+    std::optional<long double> last_run_voter_budget;
+    for (int i : increasing_order(budgets)) {
+        long double voter_budget = static_cast<long double>(budgets[i]) / n_voters;
+        if (!last_run_voter_budget || (voter_budget != *last_run_voter_budget &&
+                                       !engine.unchanged_after(voter_budget - *last_run_voter_budget))) {
+            allocation = engine.run(voter_budget);
+            last_run_voter_budget = voter_budget;
+        }
+        allocations[i] = allocation;
+    }
+    return allocations;
+}
+} // namespace
+
+std::vector<std::vector<int>> greedy_sweep(const Election &election, const std::vector<long long> &budgets,
+                                           const ProjectComparator &tie_breaking) {
+    const auto &projects = election.projects();
+    std::vector<int> ranking(projects.size());
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::ranges::sort(ranking, [&projects, &tie_breaking](int i, int j) {
+        const auto &a = projects[i], &b = projects[j];
+        if (a.num_of_approvers() == b.num_of_approvers()) {
+            return tie_breaking(a, b);
+        }
+        return a.num_of_approvers() > b.num_of_approvers();
+    });
+    return greedy_scan_sweep(projects, ranking, budgets);
+}
+
+std::vector<std::vector<int>> greedy_over_cost_sweep(const Election &election, const std::vector<long long> &budgets,
+                                                     const ProjectComparator &tie_breaking) {
+    const auto &projects = election.projects();
+    std::vector<int> ranking(projects.size());
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::ranges::sort(ranking, [&projects, &tie_breaking](int i, int j) {
+        const auto &a = projects[i], &b = projects[j];
+        long long cross_term_a_approvals_b_cost = a.num_of_approvers() * b.cost(),
+                  cross_term_b_approvals_a_cost = b.num_of_approvers() * a.cost();
+        if (cross_term_a_approvals_b_cost == cross_term_b_approvals_a_cost) {
+            return tie_breaking(a, b);
+        }
+        return cross_term_a_approvals_b_cost > cross_term_b_approvals_a_cost;
+    });
+    return greedy_scan_sweep(projects, ranking, budgets);
+}
+
+std::vector<std::vector<int>> mes_apr_sweep(const Election &election, const std::vector<long long> &budgets,
+                                            const ProjectComparator &tie_breaking) {
+    return mes_sweep<mes_detail::ApprovalUtility>(election, budgets, tie_breaking);
+}
+
+std::vector<std::vector<int>> mes_cost_sweep(const Election &election, const std::vector<long long> &budgets,
+                                             const ProjectComparator &tie_breaking) {
+    return mes_sweep<mes_detail::CostUtility>(election, budgets, tie_breaking);
+}
+
+std::vector<std::vector<int>> mes_sqrt_cost_sweep(const Election &election, const std::vector<long long> &budgets,
+                                                  const ProjectComparator &tie_breaking) {
+    return mes_sweep<mes_detail::SqrtCostUtility>(election, budgets, tie_breaking);
+}
+
+std::vector<std::vector<int>> phragmen_sweep(const Election &election, const std::vector<long long> &budgets,
+                                             const ProjectComparator &tie_breaking) {
+    // Loads do not depend on the budget, which only decides in which round the rule stops: a round is played iff the
+    // budget is at least the cost of the winners so far plus the largest cost among the tied round winners. We play
+    // every round once, with prefix maxima of these thresholds.
+    const auto &all_projects = election.projects();
+    std::vector<int> projects(all_projects.size());
+    std::iota(projects.begin(), projects.end(), 0);
+    Workspace::Scope scope;
+    phragmen_detail::PhragmenLoads loads(election, scope.workspace());
+
+    std::vector<int> winners, round_winners;
+    std::vector<long long> round_thresholds; // smallest budget for which all rounds up to this one are played
+    long long spent = 0;
+
+    while (!projects.empty() && !cancellation::requested()) {
+        long double min_max_load = std::numeric_limits<long double>::max();
+        round_winners.clear();
+        for (int index : projects) {
+            long double max_load = loads.max_load(all_projects[index]);
+
+            if (pbmath::is_less_than(max_load, min_max_load)) {
+                round_winners.clear();
+                min_max_load = max_load;
+            }
+            if (pbmath::is_equal(max_load, min_max_load)) {
+                round_winners.push_back(index);
+            }
+        }
+
+        long long threshold = spent;
+        for (int index : round_winners) {
+            threshold = std::max(threshold, spent + all_projects[index].cost());
+        }
+        round_thresholds.push_back(round_thresholds.empty() ? threshold : std::max(round_thresholds.back(), threshold));
+
+        auto project_at = [&all_projects](int index) -> const ProjectEmbedding & { return all_projects[index]; };
+        int winner = *std::ranges::min_element(round_winners, tie_breaking, project_at);
+
+        loads.select(all_projects[winner], min_max_load);
+
+        winners.push_back(winner);
+        spent += all_projects[winner].cost();
+        projects.erase(std::ranges::find(projects, winner));
+    }
+
+    std::vector<std::vector<int>> allocations;
+    allocations.reserve(budgets.size());
+    for (auto budget : budgets) {
+        int played_rounds = std::ranges::upper_bound(round_thresholds, budget) - round_thresholds.begin();
+        allocations.emplace_back(winners.begin(), winners.begin() + played_rounds);
+    }
+    return allocations;
+}
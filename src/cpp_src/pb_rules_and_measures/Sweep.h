@@ -0,0 +1,27 @@
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+
+#include <vector>
+
+// Allocations of a rule for every budget of the given list (the budget of the election is ignored), as indices into
+// election.projects() in order of selection. Work is shared between budgets: greedy rules sort once and only rescan at
+// budgets where some decision changes, Phragmén runs once (the budget only decides when it stops) and MES warm-starts
+// each budget from the previous one, skipping budgets at which no decision can change.
+
+std::vector<std::vector<int>> greedy_sweep(const Election &election, const std::vector<long long> &budgets,
+                                           const ProjectComparator &tie_breaking);
+
+std::vector<std::vector<int>> greedy_over_cost_sweep(const Election &election, const std::vector<long long> &budgets,
+                                                     const ProjectComparator &tie_breaking);
+
+std::vector<std::vector<int>> mes_apr_sweep(const Election &election, const std::vector<long long> &budgets,
+                                            const ProjectComparator &tie_breaking);
+
+std::vector<std::vector<int>> mes_cost_sweep(const Election &election, const std::vector<long long> &budgets,
+                                             const ProjectComparator &tie_breaking);
+
+std::vector<std::vector<int>> mes_sqrt_cost_sweep(const Election &election, const std::vector<long long> &budgets,
+                                                  const ProjectComparator &tie_breaking);
+
+std::vector<std::vector<int>> phragmen_sweep(const Election &election, const std::vector<long long> &budgets,
+                                             const ProjectComparator &tie_breaking);
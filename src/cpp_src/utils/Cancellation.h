@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+
+// Cooperative cancellation of the rules and measures running on a thread. A Scope installs a flag for the current
+// thread, like Workspace::local() every thread has its own; the loops of the rules and measures, the enumeration of
+// pessimist models and the ILP solver poll requested() and stop early once the flag is set. Their results are then
+// meaningless, so whoever set the flag must discard them.
+namespace cancellation {
+// Flag of the current thread, nullptr if no scope is open.
+inline const std::atomic<bool> *&flag() {
+    thread_local const std::atomic<bool> *flag = nullptr;
+    return flag;
+}
+
+inline bool requested() {
+    const auto *current = flag();
+    return current && current->load(std::memory_order_relaxed);
+}
+
+// Makes the rules and measures called on this thread stop once *flag is set, until the scope ends.
+class Scope {
+  public:
+    explicit Scope(const std::atomic<bool> *flag) : previous_(cancellation::flag()) { cancellation::flag() = flag; }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    ~Scope() { cancellation::flag() = previous_; }
+
+  private:
+    const std::atomic<bool> *previous_;
+};
+} // namespace cancellation
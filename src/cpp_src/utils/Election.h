@@ -1,18 +1,60 @@
 #pragma once
 #include "ProjectEmbedding.h"
+#include <algorithm>
+#include <numeric>
+#include <optional>
 #include <vector>
 
+// Voters are grouped into classes of identical ballots: approvers of projects are class indices and voter_weight(i) is
+// the number of voters in class i. An election constructed from num_of_voters has a class per voter.
 class Election {
   public:
     template <typename ProjectsT>
     Election(long long budget, int num_of_voters, ProjectsT &&projects)
-        : budget_(budget), num_of_voters_(num_of_voters), projects_(std::forward<ProjectsT>(projects)) {}
+        : budget_(budget), num_of_voters_(num_of_voters), voter_weights_(num_of_voters, 1),
+          projects_(std::forward<ProjectsT>(projects)) {}
+
+    template <typename ProjectsT>
+    Election(long long budget, std::vector<int> voter_weights, ProjectsT &&projects)
+        : budget_(budget), projects_(std::forward<ProjectsT>(projects)) {
+        set_voter_weights(std::move(voter_weights));
+    }
+
+    // Changes the number of voters in every class (e.g. to resample the voters), without copying the projects.
+    void set_voter_weights(std::vector<int> voter_weights) {
+        num_of_voters_ = std::reduce(voter_weights.begin(), voter_weights.end());
+        voter_weights_ = std::move(voter_weights);
+        for (auto &project : projects_) {
+            project.num_of_approvers_ = 0;
+            project.score_ = 0;
+            for (int i = 0; i < static_cast<int>(project.approvers_.size()); i++) {
+                int weight = voter_weights_[project.approvers_[i]];
+                project.num_of_approvers_ += weight;
+                project.score_ += static_cast<long long>(weight) * (project.is_cardinal() ? project.utilities_[i] : 1);
+            }
+        }
+    }
+
     long long budget() const { return budget_; }
     int num_of_voters() const { return num_of_voters_; }
+    int num_of_voter_classes() const { return voter_weights_.size(); }
+    int voter_weight(int voter_class) const { return voter_weights_[voter_class]; }
+    const std::vector<int> &voter_weights() const { return voter_weights_; }
     const std::vector<ProjectEmbedding> &projects() const { return projects_; };
 
+    // Cost of every project if all projects cost the same (committee elections), nothing otherwise. O(projects).
+    std::optional<long long> uniform_cost() const {
+        if (projects_.empty() || !std::ranges::all_of(projects_, [this](const ProjectEmbedding &project) {
+                return project.cost() == projects_.front().cost();
+            })) {
+            return {};
+        }
+        return projects_.front().cost();
+    }
+
   private:
     long long budget_;
     int num_of_voters_;
+    std::vector<int> voter_weights_;
     std::vector<ProjectEmbedding> projects_;
 };
@@ -0,0 +1,341 @@
+#include "ElectionFile.h"
+
+#include "Election.h"
+#include "ProjectEmbedding.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(int) == 4 && sizeof(long long) == 8, "sections store voter classes in 32 and costs in 64 bits");
+
+namespace {
+constexpr char MAGIC[8] = {'P', 'B', 'E', 'L', 'E', 'C', 'T', '\0'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304; // reads differently on a machine with the other byte order
+
+// Limits of the Python API, so that sums of costs and utilities of a loaded election cannot overflow.
+constexpr long long MAX_BUDGET = 1'000'000'000;
+constexpr long long MAX_UTILITY = 1'000'000'000;
+
+constexpr std::uint32_t HAS_VOTER_WEIGHTS = 1;
+constexpr std::uint32_t HAS_UTILITIES = 2;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    std::int64_t budget;
+    std::int64_t num_of_projects;
+    std::int64_t num_of_voter_classes;
+    std::int64_t num_of_approvals;
+    std::int64_t name_bytes;
+};
+static_assert(sizeof(Header) % 8 == 0);
+
+constexpr std::size_t aligned(std::size_t size) { return (size + 7) / 8 * 8; }
+
+// Offsets in bytes of the sections of an image, from its start.
+struct Layout {
+    std::size_t costs, approver_offsets, approvers, utilities, voter_weights, name_offsets, names, size;
+
+    explicit Layout(const Header &header) {
+        std::size_t projects = header.num_of_projects, approvals = header.num_of_approvals;
+        costs = sizeof(Header);
+        approver_offsets = costs + 8 * projects;
+        approvers = approver_offsets + 8 * (projects + 1);
+        utilities = approvers + aligned(4 * approvals);
+        voter_weights = utilities + (header.flags & HAS_UTILITIES ? 8 * approvals : 0);
+        name_offsets =
+            voter_weights + (header.flags & HAS_VOTER_WEIGHTS ? aligned(4 * header.num_of_voter_classes) : 0);
+        names = name_offsets + 8 * (projects + 1);
+        size = names + aligned(header.name_bytes);
+    }
+};
+
+Header header_of(const Election &election) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    const auto &weights = election.voter_weights();
+    if (std::ranges::any_of(weights, [](int weight) { return weight != 1; })) {
+        header.flags |= HAS_VOTER_WEIGHTS;
+    }
+    if (std::ranges::any_of(election.projects(), &ProjectEmbedding::is_cardinal)) {
+        header.flags |= HAS_UTILITIES;
+    }
+    header.budget = election.budget();
+    header.num_of_projects = election.projects().size();
+    header.num_of_voter_classes = election.num_of_voter_classes();
+    for (const auto &project : election.projects()) {
+        header.num_of_approvals += project.approvers().size();
+        header.name_bytes += project.name().size();
+    }
+    return header;
+}
+
+// Offsets must start at 0, never decrease and end at last.
+bool valid_offsets(const std::int64_t *offsets, std::size_t count, std::int64_t last) {
+    return offsets[0] == 0 && offsets[count - 1] == last && std::is_sorted(offsets, offsets + count);
+}
+
+// Whether text is well-formed UTF-8: no overlong encodings, surrogates or code points above U+10FFFF.
+bool is_valid_utf8(std::string_view text) {
+    for (std::size_t i = 0; i < text.size();) {
+        auto byte = static_cast<unsigned char>(text[i]);
+        int length = byte < 0x80             ? 1
+                     : (byte & 0xE0) == 0xC0 ? 2
+                     : (byte & 0xF0) == 0xE0 ? 3
+                     : (byte & 0xF8) == 0xF0 ? 4
+                                             : 0;
+        if (length == 0 || text.size() - i < static_cast<std::size_t>(length)) {
+            return false;
+        }
+        std::uint32_t code_point = length == 1 ? byte : byte & (0x7F >> length);
+        for (int j = 1; j < length; j++) {
+            auto continuation = static_cast<unsigned char>(text[i + j]);
+            if ((continuation & 0xC0) != 0x80) {
+                return false;
+            }
+            code_point = code_point << 6 | (continuation & 0x3F);
+        }
+        constexpr std::uint32_t min_code_point[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (code_point < min_code_point[length] || code_point > 0x10FFFF ||
+            (0xD800 <= code_point && code_point <= 0xDFFF)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+// Election viewing the file or shared-memory object open as fd, mapped read-only; closes fd.
+std::optional<Election> map_election(int fd) {
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        close(fd);
+        return {};
+    }
+    std::size_t size = status.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping stays valid
+    if (data == MAP_FAILED) {
+        return {};
+    }
+    std::shared_ptr<const void> mapping(data, [size](const void *data) { munmap(const_cast<void *>(data), size); });
+    return election_from_image(mapping, {static_cast<const std::byte *>(data), size});
+}
+#endif
+} // namespace
+
+std::size_t election_image_size(const Election &election) { return Layout(header_of(election)).size; }
+
+// With cardinal ballots, the approvers of the approval projects of the election, if any, get utility 1.
+void write_election_image(const Election &election, std::byte *out) {
+    Header header = header_of(election);
+    Layout layout(header);
+    std::memset(out, 0, layout.size);
+    std::memcpy(out, &header, sizeof(Header));
+
+    auto *costs = reinterpret_cast<std::int64_t *>(out + layout.costs);
+    auto *approver_offsets = reinterpret_cast<std::int64_t *>(out + layout.approver_offsets);
+    auto *approvers = reinterpret_cast<std::int32_t *>(out + layout.approvers);
+    auto *utilities = reinterpret_cast<std::int64_t *>(out + layout.utilities);
+    auto *name_offsets = reinterpret_cast<std::int64_t *>(out + layout.name_offsets);
+    auto *names = reinterpret_cast<char *>(out + layout.names);
+
+    const auto &projects = election.projects();
+    approver_offsets[0] = name_offsets[0] = 0;
+    for (std::size_t i = 0; i < projects.size(); i++) {
+        const auto &project = projects[i];
+        costs[i] = project.cost();
+        std::ranges::copy(project.approvers(), approvers + approver_offsets[i]);
+        if (header.flags & HAS_UTILITIES) {
+            if (project.is_cardinal()) {
+                std::ranges::copy(project.utilities(), utilities + approver_offsets[i]);
+            } else {
+                std::fill_n(utilities + approver_offsets[i], project.approvers().size(), 1);
+            }
+        }
+        approver_offsets[i + 1] = approver_offsets[i] + project.approvers().size();
+        std::ranges::copy(project.name(), names + name_offsets[i]);
+        name_offsets[i + 1] = name_offsets[i] + project.name().size();
+    }
+    if (header.flags & HAS_VOTER_WEIGHTS) {
+        std::ranges::copy(election.voter_weights(), reinterpret_cast<std::int32_t *>(out + layout.voter_weights));
+    }
+}
+
+std::optional<Election> election_from_image(std::shared_ptr<const void> storage, std::span<const std::byte> bytes) {
+    Header header;
+    if (bytes.size() < sizeof(Header)) {
+        return {};
+    }
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    // every count is at most the number of bytes, so that the layout cannot overflow
+    auto fits = [&bytes](std::int64_t count) {
+        return count >= 0 && static_cast<std::uint64_t>(count) <= bytes.size();
+    };
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.byte_order != BYTE_ORDER_MARK || !fits(header.num_of_projects) || !fits(header.num_of_voter_classes) ||
+        !fits(header.num_of_approvals) || !fits(header.name_bytes) ||
+        header.num_of_voter_classes > std::numeric_limits<int>::max()) {
+        return {};
+    }
+    Layout layout(header);
+    if (layout.size != bytes.size()) {
+        return {};
+    }
+
+    const auto *data = bytes.data();
+    const auto *costs = reinterpret_cast<const std::int64_t *>(data + layout.costs);
+    const auto *approver_offsets = reinterpret_cast<const std::int64_t *>(data + layout.approver_offsets);
+    const auto *approvers = reinterpret_cast<const int *>(data + layout.approvers);
+    const auto *utilities = reinterpret_cast<const long long *>(data + layout.utilities);
+    const auto *voter_weights = reinterpret_cast<const std::int32_t *>(data + layout.voter_weights);
+    const auto *name_offsets = reinterpret_cast<const std::int64_t *>(data + layout.name_offsets);
+    const auto *names = reinterpret_cast<const char *>(data + layout.names);
+
+    std::size_t num_of_projects = header.num_of_projects, num_of_approvals = header.num_of_approvals;
+    int num_of_voter_classes = header.num_of_voter_classes;
+    bool has_utilities = header.flags & HAS_UTILITIES;
+    auto is_valid_cost = [](long long cost) { return 0 < cost && cost <= MAX_BUDGET; }; // and budget
+    auto is_affordable = [&header](long long cost) { return cost <= header.budget; };
+    auto is_valid_utility = [](long long utility) { return 0 < utility && utility <= MAX_UTILITY; };
+    auto is_voter_class = [num_of_voter_classes](int approver) {
+        return 0 <= approver && approver < num_of_voter_classes;
+    };
+    if (!valid_offsets(approver_offsets, num_of_projects + 1, header.num_of_approvals) ||
+        !valid_offsets(name_offsets, num_of_projects + 1, header.name_bytes) ||
+        !std::all_of(approvers, approvers + num_of_approvals, is_voter_class) ||
+        (has_utilities && !std::all_of(utilities, utilities + num_of_approvals, is_valid_utility)) ||
+        !is_valid_cost(header.budget) || !std::all_of(costs, costs + num_of_projects, is_valid_cost) ||
+        !std::all_of(costs, costs + num_of_projects, is_affordable)) {
+        return {};
+    }
+    // as in a translated instance: every voter class approves a project at most once, in increasing order (the rules
+    // would count a repeated class twice), and names are unique (winners are mapped back to projects by name) UTF-8
+    std::unordered_set<std::string_view> distinct_names;
+    for (std::size_t i = 0; i < num_of_projects; i++) {
+        std::string_view name(names + name_offsets[i], name_offsets[i + 1] - name_offsets[i]);
+        if (std::adjacent_find(approvers + approver_offsets[i], approvers + approver_offsets[i + 1],
+                               std::greater_equal<>()) != approvers + approver_offsets[i + 1] ||
+            !is_valid_utf8(name) || !distinct_names.insert(name).second) {
+            return {};
+        }
+    }
+
+    std::vector<ProjectEmbedding> projects;
+    projects.reserve(num_of_projects);
+    for (std::size_t i = 0; i < num_of_projects; i++) {
+        std::size_t begin = approver_offsets[i], size = approver_offsets[i + 1] - begin;
+        projects.emplace_back(costs[i], std::string(names + name_offsets[i], names + name_offsets[i + 1]), storage,
+                              std::span(approvers + begin, size),
+                              has_utilities ? std::span(utilities + begin, size) : std::span<const long long>());
+    }
+    if (header.flags & HAS_VOTER_WEIGHTS) {
+        std::vector<int> weights(voter_weights, voter_weights + num_of_voter_classes);
+        long long num_of_voters = 0; // must fit in an int
+        for (int weight : weights) {
+            num_of_voters += weight;
+            if (weight < 0 || num_of_voters > std::numeric_limits<int>::max()) {
+                return {};
+            }
+        }
+        if (num_of_voters == 0) { // MES divides the budget among the voters
+            return {};
+        }
+        return Election(header.budget, std::move(weights), std::move(projects));
+    }
+    if (num_of_voter_classes == 0) {
+        return {};
+    }
+    return Election(header.budget, num_of_voter_classes, std::move(projects));
+}
+
+bool save_election(const Election &election, const std::string &path) {
+    std::vector<std::byte> image(election_image_size(election));
+    write_election_image(election, image.data());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(image.data()), image.size());
+    return static_cast<bool>(file.flush());
+}
+
+std::optional<Election> load_election(const std::string &path) {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return {};
+    }
+    auto image =
+        std::make_shared<std::vector<char>>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    std::span<const std::byte> bytes(reinterpret_cast<const std::byte *>(image->data()), image->size());
+    return election_from_image(std::move(image), bytes);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return {};
+    }
+    return map_election(fd);
+#endif
+}
+
+bool share_election(const Election &election, const std::string &name) {
+#ifdef _WIN32
+    return false;
+#else
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    std::size_t size = election_image_size(election);
+    void *data = ftruncate(fd, size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+    write_election_image(election, static_cast<std::byte *>(data));
+    munmap(data, size);
+    return true;
+#endif
+}
+
+std::optional<Election> attach_election(const std::string &name) {
+#ifdef _WIN32
+    return {};
+#else
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return {};
+    }
+    return map_election(fd);
+#endif
+}
+
+bool unlink_shared_election(const std::string &name) {
+#ifdef _WIN32
+    return false;
+#else
+    return shm_unlink(name.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Election.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+// Binary image of an election, laid out so that it can be used in place: a header, then 8-byte aligned sections with
+// the costs, the approvers of all projects in CSR form (offsets and voter classes), their utilities for cardinal
+// ballots, the voter weights if any is not 1 and the project names (offsets and characters). Integers are stored in the
+// byte order of the machine that wrote the image, which the header records.
+//
+// An Election built from an image shares its approvers and utilities instead of copying them: opening a mapped file
+// only copies the costs, names and weights, and processes that map the same file share one copy in the page cache. The
+// image can also be placed in a POSIX shared-memory object, which worker processes on the host attach in the same way.
+
+// Size in bytes of the image of the election.
+std::size_t election_image_size(const Election &election);
+
+// Writes the image of the election to out, which must hold election_image_size(election) bytes.
+void write_election_image(const Election &election, std::byte *out);
+
+// Election viewing the image in bytes, which storage must keep alive; nothing if it is not a valid image.
+std::optional<Election> election_from_image(std::shared_ptr<const void> storage, std::span<const std::byte> bytes);
+
+// Writes the image of the election to the file, false if it could not be written.
+bool save_election(const Election &election, const std::string &path);
+
+// Election viewing the memory-mapped file (read into memory where mapping is not available), nothing if the file
+// cannot be read or is not a valid image.
+std::optional<Election> load_election(const std::string &path);
+
+// Writes the image of the election to a new POSIX shared-memory object with the name (such as "/election"), readable
+// by the processes of the same user; false if it exists already or could not be written (and always on Windows).
+// Processes attach it once this returns.
+bool share_election(const Election &election, const std::string &name);
+
+// Election viewing the shared-memory object, mapped read-only, nothing if it cannot be opened or is not a valid image.
+std::optional<Election> attach_election(const std::string &name);
+
+// Removes the name of the shared-memory object, false if there is none. Elections attached to it stay valid, and the
+// memory is freed once the last of them is gone.
+bool unlink_shared_election(const std::string &name);
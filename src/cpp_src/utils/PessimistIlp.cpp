@@ -0,0 +1,125 @@
+// The ILP plugin: built as a separate library linked against OR-Tools, and loaded by PessimistModel on first use.
+
+#include "PessimistModel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ortools/linear_solver/linear_solver.h"
+
+using namespace operations_research;
+
+#ifdef _WIN32
+#define PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define PLUGIN_EXPORT
+#endif
+
+namespace {
+// Interrupts the solver once *cancelled is set, polling the flag on a thread of its own for as long as it lives, since
+// SCIP does not poll anything of ours while it solves.
+class CancellationWatch {
+  public:
+    CancellationWatch(MPSolver &solver, const std::atomic<bool> *cancelled) {
+        if (!cancelled) {
+            return;
+        }
+        watcher_ = std::jthread([this, &solver, cancelled](std::stop_token stop) {
+            auto is_cancelled = [cancelled] { return cancelled->load(std::memory_order_relaxed); };
+            std::unique_lock lock(mutex_);
+            while (!wake_.wait_for(lock, stop, std::chrono::milliseconds(10), is_cancelled)) {
+                if (stop.stop_requested()) {
+                    return;
+                }
+            }
+            solver.InterruptSolve();
+        });
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable_any wake_; // only woken by the stop request of the destructor
+    std::jthread watcher_;
+};
+} // namespace
+
+extern "C" PLUGIN_EXPORT bool pabumeasures_solve_pessimist_model(const PessimistModel &model, bool lazy,
+                                                                 const std::atomic<bool> *cancelled, int *value) {
+    const auto &type_counts = model.type_counts_;
+    const auto &rounds = model.rounds_;
+    int t = type_counts.size();
+    std::unique_ptr<MPSolver> solver(MPSolver::CreateSolver("SCIP"));
+    std::vector<const MPVariable *> x_T;
+    x_T.reserve(t);
+    for (int j = 0; j < t; j++) {
+        x_T.push_back(solver->MakeIntVar(0, type_counts[j], "x_T_" + std::to_string(j)));
+    }
+    MPObjective *const objective = solver->MutableObjective();
+    for (int j = 0; j < t; j++) {
+        objective->SetCoefficient(x_T[j], 1);
+    }
+    objective->SetMaximization();
+
+    std::vector<char> in_model(rounds.size());
+    auto add_to_model = [&](int r) {
+        const auto &round = rounds[r];
+        MPVariable *const y = round.with_choice ? solver->MakeBoolVar("y_" + std::to_string(r)) : nullptr;
+        for (const auto &row : round.rows) {
+            MPConstraint *const c = solver->MakeRowConstraint(row.lower, row.upper);
+            for (int j = 0; j < t; j++) {
+                if (row.coefficients[j] != 0) {
+                    c->SetCoefficient(x_T[j], row.coefficients[j]);
+                }
+            }
+            if (y) {
+                c->SetCoefficient(y, row.choice_coefficient);
+            }
+        }
+        in_model[r] = true;
+    };
+
+    if (!lazy) {
+        for (int r = 0; r < static_cast<int>(rounds.size()); r++) {
+            add_to_model(r);
+        }
+    } else if (!rounds.empty()) {
+        add_to_model(rounds.size() - 1); // the round at which the rule stops
+    }
+
+    CancellationWatch watch(*solver, cancelled);
+    std::vector<int> x(t);
+    while (true) {
+        if (solver->Solve() != MPSolver::OPTIMAL) {
+            return false; // leaving rounds out only relaxes the model, so the full model is not feasible either
+        }
+        if (cancelled && cancelled->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (!lazy) {
+            break;
+        }
+        for (int j = 0; j < t; j++) {
+            x[j] = std::lround(x_T[j]->solution_value());
+        }
+        bool added = false;
+        for (int r = 0; r < static_cast<int>(rounds.size()); r++) {
+            if (!in_model[r] && !model.satisfied(rounds[r], x)) {
+                add_to_model(r);
+                added = true;
+            }
+        }
+        if (!added) {
+            break;
+        }
+    }
+    // MIP solver might return something like 1.99999999, so we add 0.1 to be safe
+    *value = objective->Value() + 0.1;
+    return true;
+}
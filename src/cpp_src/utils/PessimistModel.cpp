@@ -0,0 +1,179 @@
+#include "PessimistModel.h"
+
+#include "Cancellation.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef PABUMEASURES_ILP_PLUGIN
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+#endif
+
+namespace {
+// Up to this many values of x, they are enumerated instead of calling the solver.
+constexpr long long MAX_ASSIGNMENTS_FOR_ENUMERATION = 1 << 16;
+
+// Below this many coefficients, the whole model is solved at once.
+constexpr long long MIN_COEFFICIENTS_FOR_ROW_GENERATION = 1 << 14;
+
+using SolvePessimistModel = decltype(&pabumeasures_solve_pessimist_model);
+
+// The solver from the ILP plugin, loaded on the first call; nullptr if there is none.
+SolvePessimistModel ilp_solver() {
+    static const SolvePessimistModel solver = []() -> SolvePessimistModel {
+#if defined(PABUMEASURES_ILP_PLUGIN) && defined(_WIN32)
+        std::string path = PABUMEASURES_ILP_PLUGIN;
+        HMODULE library;
+        char library_path[MAX_PATH];
+        if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                               reinterpret_cast<LPCSTR>(&ilp_solver), &library) &&
+            GetModuleFileNameA(library, library_path, MAX_PATH)) {
+            std::string directory = library_path;
+            path = directory.substr(0, directory.find_last_of("\\/") + 1) + path;
+        }
+        HMODULE handle = LoadLibraryA(path.c_str());
+        if (!handle) {
+            return nullptr;
+        }
+        return reinterpret_cast<SolvePessimistModel>(GetProcAddress(handle, "pabumeasures_solve_pessimist_model"));
+#elif defined(PABUMEASURES_ILP_PLUGIN)
+        std::string path = PABUMEASURES_ILP_PLUGIN;
+        Dl_info info;
+        if (dladdr(reinterpret_cast<void *>(&ilp_solver), &info) && info.dli_fname) {
+            std::string library = info.dli_fname;
+            path = library.substr(0, library.find_last_of('/') + 1) + path;
+        }
+        void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle) {
+            return nullptr;
+        }
+        return reinterpret_cast<SolvePessimistModel>(dlsym(handle, "pabumeasures_solve_pessimist_model"));
+#else
+        return nullptr;
+#endif
+    }();
+    return solver;
+}
+} // namespace
+
+PessimistModel::PessimistModel(std::vector<int> type_counts) : type_counts_(std::move(type_counts)) {}
+
+void PessimistModel::add_round(bool with_choice) { rounds_.push_back({with_choice, {}}); }
+
+void PessimistModel::add_row(double lower, double upper, std::vector<double> coefficients, double choice_coefficient) {
+    rounds_.back().rows.push_back({lower, upper, std::move(coefficients), choice_coefficient});
+}
+
+PessimistModel::Method PessimistModel::default_method() const {
+    long long num_of_assignments = 1;
+    for (int count : type_counts_) {
+        num_of_assignments *= count + 1;
+        if (num_of_assignments > MAX_ASSIGNMENTS_FOR_ENUMERATION) {
+            break;
+        }
+    }
+    if (num_of_assignments <= MAX_ASSIGNMENTS_FOR_ENUMERATION) {
+        return Method::ENUMERATION;
+    }
+
+    long long num_of_rows = 0;
+    for (const auto &round : rounds_) {
+        num_of_rows += round.rows.size();
+    }
+    if (rounds_.size() > 1 &&
+        num_of_rows * static_cast<long long>(type_counts_.size()) >= MIN_COEFFICIENTS_FOR_ROW_GENERATION) {
+        return Method::ROW_GENERATION;
+    }
+    return Method::FULL_MODEL;
+}
+
+std::optional<int> PessimistModel::maximize(Method method) const {
+    auto solver = ilp_solver();
+    if (method == Method::ENUMERATION || !solver) {
+        return enumerate();
+    }
+    int value;
+    if (!solver(*this, method == Method::ROW_GENERATION, cancellation::flag(), &value)) {
+        return {};
+    }
+    return value;
+}
+
+// Depth-first search over x_0, x_1, ..., trying the largest values first. For every row, the activity of the types
+// assigned so far is kept, along with the least and the most the remaining types can add to it; a branch is cut when
+// some round cannot hold whatever the remaining types are, or when it cannot beat the best sum found so far.
+std::optional<int> PessimistModel::enumerate() const {
+    int t = type_counts_.size();
+    std::vector<const Row *> rows;
+    std::vector<int> round_begin;
+    for (const auto &round : rounds_) {
+        round_begin.push_back(rows.size());
+        for (const auto &row : round.rows) {
+            rows.push_back(&row);
+        }
+    }
+    round_begin.push_back(rows.size());
+
+    // least and most of row r over types j, j + 1, ..., at [r * (t + 1) + j]
+    std::vector<double> least_rest(rows.size() * (t + 1)), most_rest(rows.size() * (t + 1));
+    for (int r = 0; r < static_cast<int>(rows.size()); r++) {
+        for (int j = t - 1; j >= 0; j--) {
+            double extreme = rows[r]->coefficients[j] * type_counts_[j];
+            least_rest[r * (t + 1) + j] = least_rest[r * (t + 1) + j + 1] + std::min(0.0, extreme);
+            most_rest[r * (t + 1) + j] = most_rest[r * (t + 1) + j + 1] + std::max(0.0, extreme);
+        }
+    }
+    std::vector<int> counts_left(t + 1);
+    for (int j = t - 1; j >= 0; j--) {
+        counts_left[j] = counts_left[j + 1] + type_counts_[j];
+    }
+
+    std::vector<double> activity(rows.size());
+    auto may_hold = [&](int round, int j) {
+        for (int y = 0; y <= rounds_[round].with_choice; y++) {
+            bool all_rows_may_hold = true;
+            for (int r = round_begin[round]; r < round_begin[round + 1] && all_rows_may_hold; r++) {
+                double base = activity[r] + rows[r]->choice_coefficient * y;
+                all_rows_may_hold = base + least_rest[r * (t + 1) + j] <= rows[r]->upper + FEASIBILITY_TOLERANCE &&
+                                    base + most_rest[r * (t + 1) + j] >= rows[r]->lower - FEASIBILITY_TOLERANCE;
+            }
+            if (all_rows_may_hold) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::optional<int> best;
+    auto search = [&](auto &&self, int j, int sum) -> void {
+        if ((best && sum + counts_left[j] <= *best) || cancellation::requested()) {
+            return;
+        }
+        for (int round = 0; round < static_cast<int>(rounds_.size()); round++) {
+            if (!may_hold(round, j)) {
+                return;
+            }
+        }
+        if (j == t) {
+            best = sum;
+            return;
+        }
+        for (int x = type_counts_[j]; x >= 0; x--) {
+            for (int r = 0; r < static_cast<int>(rows.size()); r++) {
+                activity[r] += rows[r]->coefficients[j] * x;
+            }
+            self(self, j + 1, sum + x);
+            for (int r = 0; r < static_cast<int>(rows.size()); r++) {
+                activity[r] -= rows[r]->coefficients[j] * x;
+            }
+        }
+    };
+    search(search, 0, 0);
+    return best;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+class PessimistModel;
+
+// Entry point of the ILP plugin, the only part of the library that needs OR-Tools: solves the model with SCIP, by row
+// generation if lazy, and returns whether it is feasible, with the optimal value in *value. The solve is interrupted
+// once *cancelled is set (if given), with a meaningless result; the cancellation flag of the caller's thread is passed
+// explicitly, as the plugin has thread-local variables of its own.
+extern "C" bool pabumeasures_solve_pessimist_model(const PessimistModel &model, bool lazy,
+                                                   const std::atomic<bool> *cancelled, int *value);
+
+// Integer program of the pessimist-add measures: the largest number of new approvers of p, with x_j of them taken from
+// voter type j (0 <= x_j <= count of the type), for which p is still not selected. Every round of the rule adds a group
+// of rows over the voter types; the rows of a round can share one binary variable, which encodes a disjunction.
+//
+// With few voter types, all values of x are enumerated instead, branching on one type at a time and pruning on the
+// objective and on the rounds that can no longer hold. Otherwise the model goes to the ILP solver. Only a few of the
+// rounds are usually binding, so large models are solved by row generation: the model starts from the last round, and
+// after every solve the rounds left out are checked against the solution and the violated ones are added, until there
+// are none. Other models are solved in one go, as extra solves cost more than the rows they save.
+//
+// The solver is in a separate library, loaded from the directory of this one on first use. Without it, as in builds
+// without OR-Tools, every model is enumerated, which is exact but can take much longer.
+class PessimistModel {
+  public:
+    enum class Method { ENUMERATION, FULL_MODEL, ROW_GENERATION };
+
+    explicit PessimistModel(std::vector<int> type_counts);
+
+    // Starts the group of rows of the next round; with_choice gives the round its binary variable y.
+    void add_round(bool with_choice = false);
+    // Adds lower <= coefficients * x + choice_coefficient * y <= upper to the current round.
+    void add_row(double lower, double upper, std::vector<double> coefficients, double choice_coefficient = 0);
+
+    // Optimal value of the sum of x, if the model is feasible; by default, the method depends on the size of the model.
+    std::optional<int> maximize() const { return maximize(default_method()); }
+    std::optional<int> maximize(Method method) const;
+
+    friend bool pabumeasures_solve_pessimist_model(const PessimistModel &model, bool lazy,
+                                                   const std::atomic<bool> *cancelled, int *value);
+
+  private:
+    // Same as the default feasibility tolerance of the solver, so that rows it considers satisfied are checked alike.
+    static constexpr double FEASIBILITY_TOLERANCE = 1e-6;
+
+    struct Row {
+        double lower, upper;
+        std::vector<double> coefficients;
+        double choice_coefficient;
+    };
+    struct Round {
+        bool with_choice;
+        std::vector<Row> rows;
+    };
+
+    std::vector<int> type_counts_;
+    std::vector<Round> rounds_;
+
+    Method default_method() const;
+    bool satisfied(const Round &round, const std::vector<int> &x) const;
+    std::optional<int> enumerate() const;
+};
+
+// The rows of a round hold for x if they hold for some value of its binary variable.
+inline bool PessimistModel::satisfied(const Round &round, const std::vector<int> &x) const {
+    for (int y = 0; y <= round.with_choice; y++) {
+        bool all_rows_hold = true;
+        for (const auto &row : round.rows) {
+            double activity =
+                std::inner_product(x.begin(), x.end(), row.coefficients.begin(), row.choice_coefficient * y);
+            if (activity < row.lower - FEASIBILITY_TOLERANCE || activity > row.upper + FEASIBILITY_TOLERANCE) {
+                all_rows_hold = false;
+                break;
+            }
+        }
+        if (all_rows_hold) {
+            return true;
+        }
+    }
+    return false;
+}
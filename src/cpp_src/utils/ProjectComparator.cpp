@@ -34,7 +34,7 @@ std::strong_ordering ProjectComparator::compare(const ProjectEmbedding &a, const
     case Comparator::COST:
         return apply_order(a.cost_ <=> b.cost_, order);
     case Comparator::VOTES:
-        return apply_order(a.approvers_.size() <=> b.approvers_.size(), order);
+        return apply_order(a.num_of_approvers_ <=> b.num_of_approvers_, order);
     case Comparator::LEXICOGRAPHIC:
         return apply_order(a.name_ <=> b.name_, order);
     }
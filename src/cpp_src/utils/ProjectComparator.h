@@ -14,6 +14,8 @@ class ProjectComparator {
 
     bool operator()(const ProjectEmbedding &a, const ProjectEmbedding &b) const;
 
+    const std::vector<std::pair<Comparator, Ordering>> &criteria() const { return criteria_; }
+
     // Static predefined comparators:
     static const ProjectComparator ByCostAsc;
     static const ProjectComparator ByCostDesc;
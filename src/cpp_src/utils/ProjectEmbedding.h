@@ -1,27 +1,83 @@
 #pragma once
 #include <compare>
+#include <memory>
+#include <numeric>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
 
+class Election;
+class GreedyTally;
 class ProjectComparator;
 
 class ProjectEmbedding {
   public:
-    template <typename StringT, typename VectorT>
-    ProjectEmbedding(long long cost, StringT &&name, VectorT &&approvers)
-        : cost_(cost), name_(std::forward<StringT>(name)), approvers_(std::forward<VectorT>(approvers)) {}
+    ProjectEmbedding(long long cost, std::string name, std::vector<int> approvers)
+        : ProjectEmbedding(cost, std::move(name), std::move(approvers), std::vector<long long>{}) {
+        score_ = num_of_approvers_;
+    }
+
+    // approvers are voter classes of an election with weighted voters, num_of_approvers is the number of real voters
+    ProjectEmbedding(long long cost, std::string name, std::vector<int> approvers, int num_of_approvers)
+        : ProjectEmbedding(cost, std::move(name), std::move(approvers)) {
+        num_of_approvers_ = num_of_approvers;
+        score_ = num_of_approvers;
+    }
+
+    // Copies the approvers, e.g. of another project.
+    ProjectEmbedding(long long cost, std::string name, std::span<const int> approvers, int num_of_approvers)
+        : ProjectEmbedding(cost, std::move(name), std::vector<int>(approvers.begin(), approvers.end()),
+                           num_of_approvers) {}
+
+    // Cardinal (e.g. cumulative or scoring) ballots: utilities[i] > 0 is the utility of every voter of class
+    // approvers[i] from the project, stored as a parallel array so that kernels scan both sequentially.
+    ProjectEmbedding(long long cost, std::string name, std::vector<int> approvers, std::vector<long long> utilities)
+        : cost_(cost), name_(std::move(name)) {
+        auto storage = std::make_shared<OwnedStorage>(std::move(approvers), std::move(utilities));
+        approvers_ = storage->approvers;
+        utilities_ = storage->utilities;
+        storage_ = std::move(storage);
+        num_of_approvers_ = approvers_.size();
+        score_ = std::reduce(utilities_.begin(), utilities_.end(), 0LL);
+    }
+
+    // Approvers (and utilities, empty for approval ballots) that point into memory kept alive by storage, such as a
+    // mapped election file, so that they are not copied.
+    ProjectEmbedding(long long cost, std::string name, std::shared_ptr<const void> storage,
+                     std::span<const int> approvers, std::span<const long long> utilities)
+        : cost_(cost), name_(std::move(name)), storage_(std::move(storage)), approvers_(approvers),
+          utilities_(utilities), num_of_approvers_(approvers.size()),
+          score_(utilities.empty() ? num_of_approvers_ : std::reduce(utilities.begin(), utilities.end(), 0LL)) {}
 
     bool operator==(const ProjectEmbedding &other) const { return name_ == other.name_; }
     long long cost() const { return cost_; }
     const std::string &name() const { return name_; }
-    const std::vector<int> &approvers() const { return approvers_; }
-    int num_of_approvers() const { return approvers_.size(); }
+    std::span<const int> approvers() const { return approvers_; }
+    int num_of_approvers() const { return num_of_approvers_; }
+    // Empty for approval ballots, where every approver gets utility 1.
+    std::span<const long long> utilities() const { return utilities_; }
+    bool is_cardinal() const { return !utilities_.empty(); }
+    // Total utility of all voters from the project, num_of_approvers for approval ballots.
+    long long score() const { return score_; }
 
+    friend class Election;
+    friend class GreedyTally;
     friend class ProjectComparator;
 
   private:
+    struct OwnedStorage {
+        std::vector<int> approvers;
+        std::vector<long long> utilities;
+    };
+
     long long cost_;
     std::string name_;
-    std::vector<int> approvers_;
+    // Approvers and utilities are immutable views into storage_, shared by the copies of the project, so copying a
+    // project does not copy them.
+    std::shared_ptr<const void> storage_;
+    std::span<const int> approvers_;
+    std::span<const long long> utilities_;
+    int num_of_approvers_;
+    long long score_;
 };
@@ -0,0 +1,115 @@
+#include "Rational.h"
+
+#include <compare>
+
+namespace {
+using Integer = Rational::Integer;
+
+constexpr Integer MAX = ((Integer{1} << (sizeof(Integer) * 8 - 2)) - 1) * 2 + 1;
+
+Integer abs(Integer a) { return a < 0 ? -a : a; }
+
+Integer gcd(Integer a, Integer b) {
+    a = abs(a), b = abs(b);
+    while (b != 0) {
+        Integer r = a % b;
+        a = b, b = r;
+    }
+    return a;
+}
+
+// Checked operations on values in [-MAX, MAX]; they return false if the result is not in that range.
+bool add(Integer a, Integer b, Integer &result) {
+    if (b > 0 ? a > MAX - b : a < -MAX - b) {
+        return false;
+    }
+    result = a + b;
+    return true;
+}
+
+bool multiply(Integer a, Integer b, Integer &result) {
+    if (a != 0 && abs(b) > MAX / abs(a)) {
+        return false;
+    }
+    result = a * b;
+    return true;
+}
+
+Integer floor_div(Integer a, Integer b) { // b > 0
+    Integer q = a / b;
+    return q * b > a ? q - 1 : q;
+}
+} // namespace
+
+Rational::Rational(Integer numerator, Integer denominator) : numerator_(numerator), denominator_(denominator) {
+    if (denominator_ < 0) {
+        numerator_ = -numerator_, denominator_ = -denominator_;
+    }
+    if (denominator_ != 0) {
+        Integer g = gcd(numerator_, denominator_);
+        numerator_ /= g, denominator_ /= g;
+    }
+}
+
+Rational operator+(const Rational &a, const Rational &b) {
+    if (!a.valid() || !b.valid()) {
+        return Rational::invalid();
+    }
+    // a/b + c/d = (a * (d/g) + c * (b/g)) / (b/g * d) with g = gcd(b, d), which keeps the intermediate values small
+    Integer g = gcd(a.denominator_, b.denominator_);
+    Integer left, right, numerator, denominator;
+    if (!multiply(a.numerator_, b.denominator_ / g, left) || !multiply(b.numerator_, a.denominator_ / g, right) ||
+        !add(left, right, numerator) || !multiply(a.denominator_ / g, b.denominator_, denominator)) {
+        return Rational::invalid();
+    }
+    return Rational(numerator, denominator);
+}
+
+Rational operator-(const Rational &a, const Rational &b) {
+    Rational negated = b;
+    negated.numerator_ = -negated.numerator_;
+    return a + negated;
+}
+
+Rational operator*(const Rational &a, long long b) {
+    if (!a.valid()) {
+        return a;
+    }
+    Integer g = gcd(b, a.denominator_), numerator;
+    if (!multiply(a.numerator_, b / g, numerator)) {
+        return Rational::invalid();
+    }
+    return Rational(numerator, a.denominator_ / g);
+}
+
+Rational operator/(const Rational &a, long long b) {
+    if (!a.valid() || b == 0) {
+        return Rational::invalid();
+    }
+    Integer g = gcd(a.numerator_, b), denominator;
+    if (!multiply(a.denominator_, b / g, denominator)) {
+        return Rational::invalid();
+    }
+    return Rational(a.numerator_ / g, denominator);
+}
+
+// Compares the integer parts, and if they are equal, the fractional parts r1/b and r2/d through their reciprocals, as
+// in continued fraction expansions: r1/b < r2/d exactly when d/r2 < b/r1.
+std::strong_ordering operator<=>(const Rational &x, const Rational &y) {
+    if (!x.valid() || !y.valid()) {
+        return std::strong_ordering::equal;
+    }
+    Integer a = x.numerator_, b = x.denominator_, c = y.numerator_, d = y.denominator_;
+    while (true) {
+        Integer q = floor_div(a, b), s = floor_div(c, d);
+        if (q != s) {
+            return q <=> s;
+        }
+        Integer r1 = a - q * b, r2 = c - s * d;
+        if (r1 == 0 || r2 == 0) {
+            return r1 <=> r2;
+        }
+        a = d, c = b;
+        b = r2, d = r1;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <compare>
+
+// Exact rational number for the exact versions of the rules, with a 128-bit numerator and denominator (64-bit on
+// compilers without __int128). Values are kept reduced, with a positive denominator. An operation whose result does
+// not fit gives an invalid value instead of wrapping around, and every value computed from an invalid one is invalid.
+class Rational {
+  public:
+#ifdef __SIZEOF_INT128__
+    using Integer = __int128;
+#else
+    using Integer = long long;
+#endif
+
+    Rational(long long value = 0) : numerator_(value), denominator_(1) {}
+    Rational(Integer numerator, Integer denominator);
+
+    static Rational invalid() {
+        Rational result;
+        result.denominator_ = 0;
+        return result;
+    }
+
+    bool valid() const { return denominator_ != 0; }
+    Integer numerator() const { return numerator_; }
+    Integer denominator() const { return denominator_; }
+    long double to_long_double() const { return static_cast<long double>(numerator_) / denominator_; }
+
+    friend Rational operator+(const Rational &a, const Rational &b);
+    friend Rational operator-(const Rational &a, const Rational &b);
+    friend Rational operator*(const Rational &a, long long b);
+    friend Rational operator/(const Rational &a, long long b);
+    Rational &operator+=(const Rational &b) { return *this = *this + b; }
+    Rational &operator-=(const Rational &b) { return *this = *this - b; }
+
+    // Exact for valid values, without products that could overflow; invalid values compare as equal to everything.
+    friend std::strong_ordering operator<=>(const Rational &a, const Rational &b);
+    friend bool operator==(const Rational &a, const Rational &b) { return (a <=> b) == 0; }
+
+  private:
+    Integer numerator_, denominator_;
+};
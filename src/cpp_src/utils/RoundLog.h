@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+
+// Columnar record of the rounds of MES or Phragmén, filled in when a RoundLog is passed to the rule. The per-round
+// columns have an entry per round; the payments of round r are the entries payment_offsets[r], ...,
+// payment_offsets[r + 1] - 1 of the payment columns, one per voter class that paid (the offsets of an Arrow large
+// list). Rules append while they update the voter classes anyway, so recording adds amortized O(1) per payment.
+struct RoundLog {
+    std::vector<int> winners;    // index into election.projects() of the project selected in every round
+    std::vector<double> prices;  // MES: max payment per unit of utility, Phragmén: new load of the winner's approvers
+    std::vector<long long> payment_offsets{0};
+    std::vector<int> payment_voter_classes;
+    std::vector<double> payment_amounts; // paid by every voter of the class (MES), load it took on (Phragmén)
+
+    void clear() {
+        winners.clear();
+        prices.clear();
+        payment_offsets.assign(1, 0);
+        payment_voter_classes.clear();
+        payment_amounts.clear();
+    }
+
+    void add_round(int winner, long double price) {
+        winners.push_back(winner);
+        prices.push_back(static_cast<double>(price));
+        payment_offsets.push_back(payment_offsets.back());
+    }
+
+    // Adds a payment to the last round.
+    void add_payment(int voter_class, long double amount) {
+        payment_voter_classes.push_back(voter_class);
+        payment_amounts.push_back(static_cast<double>(amount));
+        payment_offsets.back()++;
+    }
+};
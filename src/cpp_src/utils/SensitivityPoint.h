@@ -0,0 +1,11 @@
+#pragma once
+#include <optional>
+
+// One round of a rule, seen from a fixed project p. A sensitivity curve has a point per round, up to the round in which
+// p is selected (winner == p, price == p's cost, added_approvers == 0) or the end of the rule. The cost reduction
+// measure is the largest price of the curve and the optimist-add measure is its smallest number of added approvers.
+struct SensitivityPoint {
+    int winner;                         // index of the project selected in this round, -1 once nothing is affordable
+    long long price;                    // largest cost at which p would be selected in this round instead (0 if none)
+    std::optional<int> added_approvers; // fewest new approvers p would need to be selected in this round instead
+};
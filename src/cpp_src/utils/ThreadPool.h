@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal fork-join pool used to evaluate the candidates of a single round in parallel. The calling thread takes part
+// in the work, so a pool of size 1 runs everything inline without any synchronization.
+class ThreadPool {
+  public:
+    // num_threads <= 0 means one thread per hardware thread
+    explicit ThreadPool(int num_threads) {
+        if (num_threads <= 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (int i = 1; i < num_threads; i++) {
+            workers_.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    int size() const { return workers_.size() + 1; }
+
+    // Calls f(begin, end) on contiguous chunks covering [0, n) and waits for all of them. Chunk boundaries depend only
+    // on n and the pool size, so any reduction done afterwards in index order is deterministic.
+    template <typename F> void parallel_for(int n, F &&f) {
+        int chunks = std::min(size(), n);
+        if (chunks <= 1) {
+            if (n > 0) {
+                f(0, n);
+            }
+            return;
+        }
+        auto run_chunk = [n, chunks, &f](int chunk) {
+            int begin = static_cast<long long>(n) * chunk / chunks;
+            int end = static_cast<long long>(n) * (chunk + 1) / chunks;
+            if (begin < end) {
+                f(begin, end);
+            }
+        };
+        {
+            std::lock_guard lock(mutex_);
+            task_ = run_chunk;
+            active_chunks_ = chunks;
+            pending_ = chunks - 1;
+            generation_++;
+        }
+        start_.notify_all();
+        run_chunk(0);
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+    }
+
+  private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    std::function<void(int)> task_;
+    int active_chunks_ = 0, pending_ = 0;
+    long long generation_ = 0;
+    bool stopping_ = false;
+
+    void work(int id) {
+        long long seen_generation = 0;
+        while (true) {
+            std::function<void(int)> task;
+            {
+                std::unique_lock lock(mutex_);
+                start_.wait(lock, [this, seen_generation] { return stopping_ || generation_ != seen_generation; });
+                if (stopping_) {
+                    return;
+                }
+                seen_generation = generation_;
+                if (id >= active_chunks_) {
+                    continue;
+                }
+                task = task_;
+            }
+            task(id);
+            {
+                std::lock_guard lock(mutex_);
+                pending_--;
+            }
+            done_.notify_one();
+        }
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <queue>
+#include <vector>
+
+// Scratch memory for rules and measures. Memory is handed out by bumping a pointer through a chain of blocks that is
+// kept between calls, and a Scope gives back everything allocated since it was opened in O(1). Scopes nest, so a
+// measure running a rule (or the same rule many times) keeps reusing the same blocks. Every thread has its own
+// workspace (see local()), so concurrent callers never share one.
+class Workspace : public std::pmr::memory_resource {
+  public:
+    // Restores the workspace to its state from the construction of the scope. Containers using the workspace must not
+    // outlive the scope they were created in.
+    class Scope {
+      public:
+        explicit Scope(Workspace &workspace = Workspace::local())
+            : workspace_(workspace), block_(workspace.block_), offset_(workspace.offset_) {}
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope() {
+            workspace_.block_ = block_;
+            workspace_.offset_ = offset_;
+        }
+
+        Workspace &workspace() const { return workspace_; }
+
+      private:
+        Workspace &workspace_;
+        std::size_t block_, offset_;
+    };
+
+    explicit Workspace(std::size_t block_size = 1 << 16) { blocks_.emplace_back(block_size); }
+
+    Workspace(const Workspace &) = delete;
+    Workspace &operator=(const Workspace &) = delete;
+
+    static Workspace &local() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
+
+    // Empty vector that can take capacity elements without allocating again.
+    template <typename T> std::pmr::vector<T> reserved(std::size_t capacity) {
+        std::pmr::vector<T> result(this);
+        result.reserve(capacity);
+        return result;
+    }
+
+  private:
+    struct Block {
+        explicit Block(std::size_t size) : data(new std::byte[size]), size(size) {}
+
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    std::size_t block_ = 0, offset_ = 0;
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        while (true) {
+            auto &block = blocks_[block_];
+            void *pointer = block.data.get() + offset_;
+            std::size_t space = block.size - offset_;
+            if (std::align(alignment, bytes, pointer, space)) {
+                offset_ = static_cast<std::byte *>(pointer) - block.data.get() + bytes;
+                return pointer;
+            }
+            // blocks after the current one are free, so a block too small for this request can be replaced
+            std::size_t required = bytes + alignment;
+            if (block_ + 1 == blocks_.size()) {
+                blocks_.emplace_back(std::max(required, 2 * block.size));
+            } else if (blocks_[block_ + 1].size < required) {
+                blocks_[block_ + 1] = Block(std::max(required, 2 * blocks_[block_ + 1].size));
+            }
+            block_++;
+            offset_ = 0;
+        }
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {} // freed when the scope ends
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+// Min-heap kept in a workspace.
+template <typename T> using WorkspaceMinHeap = std::priority_queue<T, std::pmr::vector<T>, std::greater<T>>;
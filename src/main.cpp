@@ -1,19 +1,129 @@
+#include "cpp_src/pb_rules_and_measures/Exact.h"
 #include "cpp_src/pb_rules_and_measures/Greedy.h"
 #include "cpp_src/pb_rules_and_measures/GreedyOverCost.h"
+#include "cpp_src/pb_rules_and_measures/GreedyTally.h"
 #include "cpp_src/pb_rules_and_measures/MesApr.h"
+#include "cpp_src/pb_rules_and_measures/MesCompletion.h"
 #include "cpp_src/pb_rules_and_measures/MesCost.h"
+#include "cpp_src/pb_rules_and_measures/MesSqrtCost.h"
 #include "cpp_src/pb_rules_and_measures/Phragmen.h"
+#include "cpp_src/pb_rules_and_measures/Recount.h"
+#include "cpp_src/pb_rules_and_measures/Robustness.h"
+#include "cpp_src/pb_rules_and_measures/Sweep.h"
+#include "cpp_src/utils/Cancellation.h"
 #include "cpp_src/utils/Election.h"
+#include "cpp_src/utils/ElectionFile.h"
 #include "cpp_src/utils/ProjectComparator.h"
 #include "cpp_src/utils/ProjectEmbedding.h"
+#include "cpp_src/utils/RoundLog.h"
+#include "cpp_src/utils/SensitivityPoint.h"
 #include <pybind11/native_enum.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
 using namespace std;
 using namespace pybind11::literals;
 namespace py = pybind11;
 
+namespace {
+// Flag of a computation that Python may cancel from another thread; `with token:` installs it on the current thread.
+struct CancellationToken {
+    std::atomic<bool> cancelled = false;
+};
+
+// Scopes of the `with token:` blocks open on this thread, innermost last.
+thread_local std::vector<std::unique_ptr<cancellation::Scope>> token_scopes;
+
+// Result of f, computed without the GIL so that other Python threads, which may cancel it, run meanwhile.
+template <typename F> auto without_gil(F &&f) {
+    py::gil_scoped_release release;
+    return f();
+}
+
+// Read-only NumPy view of a vector or span owned by self, valid as long as self is alive and the values do not change.
+template <typename Values> auto read_only_view(py::object self, const Values &values) {
+    py::array_t<typename Values::value_type> view(values.size(), values.data(), self);
+    view.attr("setflags")("write"_a = false);
+    return view;
+}
+
+// Positions of the winners in election.projects(), in order of selection.
+py::array_t<int> winner_indices(const Election &election, const std::vector<ProjectEmbedding> &winners) {
+    const auto &projects = election.projects();
+    std::unordered_map<std::string_view, int> index_of;
+    index_of.reserve(projects.size());
+    for (int i = 0; i < projects.size(); i++) {
+        index_of.emplace(projects[i].name(), i);
+    }
+    py::array_t<int> indices(winners.size());
+    auto out = indices.mutable_unchecked<1>();
+    for (int i = 0; i < winners.size(); i++) {
+        out(i) = index_of.at(winners[i].name());
+    }
+    return indices;
+}
+
+// Winner indices of an exact rule, None if its arithmetic overflowed.
+template <auto rule>
+std::optional<py::array_t<int>> exact_winner_indices(const Election &election, const ProjectComparator &tie_breaking) {
+    auto winners = without_gil([&] { return rule(election, tie_breaking); });
+    if (!winners) {
+        return {};
+    }
+    return winner_indices(election, *winners);
+}
+
+// Result of a MES completion or budget sweep. They run on mes_detail::MesBudgetIncrementer, whose payments and
+// comparisons weigh every approver equally, so elections with cardinal ballots are rejected.
+template <auto rule, typename... Args> auto approval_only(const Election &election, const Args &...args) {
+    if (std::ranges::any_of(election.projects(), &ProjectEmbedding::is_cardinal)) {
+        throw py::type_error("Profile must be of type ApprovalProfile");
+    }
+    return without_gil([&] { return rule(election, args...); });
+}
+
+// Value of the measure for every project of the election, -1 if the measure has no value for the project. Once
+// cancelled, the remaining projects are skipped.
+template <auto measure>
+py::array_t<long long> measure_values(const Election &election, const ProjectComparator &tie_breaking) {
+    auto values = without_gil([&] {
+        std::vector<long long> values(election.projects().size(), -1);
+        for (int p = 0; p < election.projects().size() && !cancellation::requested(); p++) {
+            auto value = measure(election, p, tie_breaking);
+            if constexpr (std::is_same_v<decltype(value), std::optional<int>>) {
+                values[p] = value.value_or(-1);
+            } else {
+                values[p] = value;
+            }
+        }
+        return values;
+    });
+    return py::array_t<long long>(values.size(), values.data());
+}
+
+template <auto cost_reduction, auto optimist_add, auto pessimist_add, auto singleton_add>
+void def_measure_values(py::module_ &m, const std::string &rule, const std::string &rule_doc) {
+    m.def(("cost_reduction_for_" + rule + "_values").c_str(), &measure_values<cost_reduction>,
+          ("Cost reduction measure for " + rule_doc + " for every project").c_str(), "election"_a, "tie_breaking"_a);
+    m.def(("optimist_add_for_" + rule + "_values").c_str(), &measure_values<optimist_add>,
+          ("Optimist-add measure for " + rule_doc + " for every project").c_str(), "election"_a, "tie_breaking"_a);
+    m.def(("pessimist_add_for_" + rule + "_values").c_str(), &measure_values<pessimist_add>,
+          ("Pessimist-add measure for " + rule_doc + " for every project").c_str(), "election"_a, "tie_breaking"_a);
+    m.def(("singleton_add_for_" + rule + "_values").c_str(), &measure_values<singleton_add>,
+          ("Singleton-add measure for " + rule_doc + " for every project").c_str(), "election"_a, "tie_breaking"_a);
+}
+} // namespace
+
 PYBIND11_MODULE(_core, m) {
     m.doc() = "core module with all internal functions";
 
@@ -30,16 +140,26 @@ PYBIND11_MODULE(_core, m) {
 
     py::class_<ProjectEmbedding>(m, "ProjectEmbedding")
         .def(py::init<long long, std::string, std::vector<int>>(), "cost"_a, "name"_a, "approvers"_a)
+        .def(py::init<long long, std::string, std::vector<int>, std::vector<long long>>(), "cost"_a, "name"_a,
+             "approvers"_a, "utilities"_a)
         .def_property_readonly("cost", &ProjectEmbedding::cost)
         .def_property_readonly("name", &ProjectEmbedding::name)
-        .def_property_readonly("approvers", &ProjectEmbedding::approvers)
-        .def_property_readonly("num_of_approvers", &ProjectEmbedding::num_of_approvers);
+        // read-only NumPy views, valid as long as the ProjectEmbedding is alive
+        .def_property_readonly(
+            "approvers",
+            [](py::object self) { return read_only_view(self, self.cast<const ProjectEmbedding &>().approvers()); })
+        .def_property_readonly(
+            "utilities",
+            [](py::object self) { return read_only_view(self, self.cast<const ProjectEmbedding &>().utilities()); })
+        .def_property_readonly("num_of_approvers", &ProjectEmbedding::num_of_approvers)
+        .def_property_readonly("score", &ProjectEmbedding::score);
 
     py::class_<ProjectComparator>(m, "ProjectComparator")
         .def(py::init<std::vector<std::pair<ProjectComparator::Comparator, ProjectComparator::Ordering>>>(),
              "criteria"_a)
         .def(py::init<ProjectComparator::Comparator, ProjectComparator::Ordering>(), "comparator"_a, "ordering"_a)
         .def("__call__", &ProjectComparator::operator())
+        .def_property_readonly("criteria", &ProjectComparator::criteria)
         // static default comparators
         .def_property_readonly_static("ByCostAsc", [](py::object) { return ProjectComparator::ByCostAsc; })
         .def_property_readonly_static("ByCostDesc", [](py::object) { return ProjectComparator::ByCostDesc; })
@@ -53,84 +173,393 @@ PYBIND11_MODULE(_core, m) {
 
     py::class_<Election>(m, "Election")
         .def(py::init<long long, int, std::vector<ProjectEmbedding>>(), "budget"_a, "num_of_voters"_a, "projects"_a)
+        .def(py::init<long long, std::vector<int>, std::vector<ProjectEmbedding>>(), "budget"_a, "voter_weights"_a,
+             "projects"_a)
         .def_property_readonly("budget", &Election::budget)
         .def_property_readonly("num_of_voters", &Election::num_of_voters)
+        .def_property_readonly("num_of_voter_classes", &Election::num_of_voter_classes)
+        .def_property_readonly("voter_weights", &Election::voter_weights)
         .def_property_readonly("projects", &Election::projects);
 
-    m.def("greedy", &greedy, "GreedyAV", "election"_a, "tie_breaking"_a);
+    py::class_<SensitivityPoint>(m, "SensitivityPoint")
+        .def_readonly("winner", &SensitivityPoint::winner)
+        .def_readonly("price", &SensitivityPoint::price)
+        .def_readonly("added_approvers", &SensitivityPoint::added_approvers);
+
+    // read-only NumPy views of the columns, valid until the log is filled again (pabumeasures.RoundLog fills a new log
+    // on every run, so the views it hands out stay valid)
+    py::class_<RoundLog>(m, "RoundLog")
+        .def(py::init<>())
+        .def_property_readonly(
+            "winners", [](py::object self) { return read_only_view(self, self.cast<const RoundLog &>().winners); })
+        .def_property_readonly(
+            "prices", [](py::object self) { return read_only_view(self, self.cast<const RoundLog &>().prices); })
+        .def_property_readonly(
+            "payment_offsets",
+            [](py::object self) { return read_only_view(self, self.cast<const RoundLog &>().payment_offsets); })
+        .def_property_readonly(
+            "payment_voter_classes",
+            [](py::object self) { return read_only_view(self, self.cast<const RoundLog &>().payment_voter_classes); })
+        .def_property_readonly(
+            "payment_amounts",
+            [](py::object self) { return read_only_view(self, self.cast<const RoundLog &>().payment_amounts); });
+
+    // the rules and measures called within `with token:` stop early once the token is cancelled, from any thread
+    py::class_<CancellationToken>(m, "CancellationToken")
+        .def(py::init<>())
+        .def("cancel", [](CancellationToken &token) { token.cancelled = true; })
+        .def_property_readonly("cancelled", [](const CancellationToken &token) { return token.cancelled.load(); })
+        .def("__enter__",
+             [](py::object self) {
+                 const auto &token = self.cast<const CancellationToken &>();
+                 token_scopes.push_back(std::make_unique<cancellation::Scope>(&token.cancelled));
+                 return self;
+             })
+        .def("__exit__", [](const CancellationToken &, py::args) { token_scopes.pop_back(); });
+
+    m.def("cancellation_requested", &cancellation::requested,
+          "Whether the token of the innermost `with token:` block open on this thread is cancelled");
+
+    py::class_<GreedyTally>(m, "GreedyTally")
+        .def(py::init<const Election &, const ProjectComparator &, bool>(), "election"_a, "tie_breaking"_a,
+             "over_cost"_a)
+        .def("add_ballot", &GreedyTally::add_ballot, "approved"_a)
+        .def("retract_ballot", &GreedyTally::retract_ballot, "approved"_a)
+        .def("allocation", &GreedyTally::allocation)
+        .def("cost_reduction", &GreedyTally::cost_reduction, "p"_a);
+
+    py::native_enum<Recount::Rule>(m, "RecountRule", "enum.Enum")
+        .value("MES_APR", Recount::Rule::MES_APR)
+        .value("MES_COST", Recount::Rule::MES_COST)
+        .value("PHRAGMEN", Recount::Rule::PHRAGMEN)
+        .finalize();
+
+    py::class_<Recount>(m, "Recount")
+        .def(py::init<const Election &, Recount::Rule, const ProjectComparator &>(), "election"_a, "rule"_a,
+             "tie_breaking"_a)
+        .def("set_weight", &Recount::set_weight, "voter_class"_a, "weight"_a)
+        .def("add_voter_class", &Recount::add_voter_class, "approved"_a, "weight"_a)
+        .def("winners", &Recount::winners)
+        .def_property_readonly("resumed_round", &Recount::resumed_round);
+
+    py::native_enum<SampledRule>(m, "SampledRule", "enum.Enum")
+        .value("GREEDY", SampledRule::GREEDY)
+        .value("GREEDY_OVER_COST", SampledRule::GREEDY_OVER_COST)
+        .value("MES_APR", SampledRule::MES_APR)
+        .value("MES_COST", SampledRule::MES_COST)
+        .value("PHRAGMEN", SampledRule::PHRAGMEN)
+        .finalize();
+
+    py::native_enum<Resampling>(m, "Resampling", "enum.Enum")
+        .value("BOOTSTRAP", Resampling::BOOTSTRAP)
+        .value("DROP", Resampling::DROP)
+        .finalize();
+
+    m.def(
+        "selection_frequencies",
+        [](const Election &election, SampledRule rule, Resampling resampling, double drop_fraction, int num_samples,
+           unsigned long long seed, const ProjectComparator &tie_breaking, int num_threads) {
+            std::vector<double> frequencies;
+            {
+                py::gil_scoped_release release;
+                frequencies = selection_frequencies(election, rule, resampling, drop_fraction, num_samples, seed,
+                                                    tie_breaking, num_threads);
+            }
+            return py::array_t<double>(frequencies.size(), frequencies.data());
+        },
+        "Fraction of resampled elections in which each project is selected by the rule", "election"_a, "rule"_a,
+        "resampling"_a, "drop_fraction"_a, "num_samples"_a, "seed"_a, "tie_breaking"_a, "num_threads"_a = 1);
+
+    m.def("save_election", &save_election, "Writes the election to a binary file, false if it could not be written",
+          "election"_a, "path"_a);
+    m.def("load_election", &load_election,
+          "Election memory-mapping a binary file, None if it cannot be read or is not a valid election file", "path"_a);
+    m.def("share_election", &share_election,
+          "Writes the election to a new POSIX shared-memory object, false if it exists or could not be written",
+          "election"_a, "name"_a);
+    m.def("attach_election", &attach_election,
+          "Election mapping a POSIX shared-memory object read-only, None if it cannot be opened or is not valid",
+          "name"_a);
+    m.def("unlink_shared_election", &unlink_shared_election,
+          "Removes the name of a POSIX shared-memory object, false if there is none", "name"_a);
+
+    m.def("greedy", &greedy, "GreedyAV", "election"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("cost_reduction_for_greedy", &cost_reduction_for_greedy, "Cost reduction measure for GreedyAV", "election"_a,
-          "p"_a, "tie_breaking"_a);
+          "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("optimist_add_for_greedy", &optimist_add_for_greedy, "optimist-add measure for GreedyAV", "election"_a, "p"_a,
-          "tie_breaking"_a);
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("pessimist_add_for_greedy", &pessimist_add_for_greedy, "pessimist-add measure for GreedyAV", "election"_a,
-          "p"_a, "tie_breaking"_a);
+          "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("singleton_add_for_greedy", &singleton_add_for_greedy, "singleton-add measure for GreedyAV", "election"_a,
-          "p"_a, "tie_breaking"_a);
+          "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
-    m.def("greedy_over_cost", &greedy_over_cost, "GreedyAV/Cost", "election"_a, "tie_breaking"_a);
+    m.def("greedy_over_cost", &greedy_over_cost, "GreedyAV/Cost", "election"_a, "tie_breaking"_a,
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("cost_reduction_for_greedy_over_cost", &cost_reduction_for_greedy_over_cost,
-          "Cost reduction measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a);
+          "Cost reduction measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a,
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("optimist_add_for_greedy_over_cost", &optimist_add_for_greedy_over_cost,
-          "optimist-add measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a);
+          "optimist-add measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a,
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("pessimist_add_for_greedy_over_cost", &pessimist_add_for_greedy_over_cost,
-          "pessimist-add measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a);
+          "pessimist-add measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a,
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("singleton_add_for_greedy_over_cost", &singleton_add_for_greedy_over_cost,
-          "singleton-add measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a);
+          "singleton-add measure for GreedyAV/Cost", "election"_a, "p"_a, "tie_breaking"_a,
+          py::call_guard<py::gil_scoped_release>());
 
-    m.def("mes_apr", &mes_apr, "Method of Equal Shares with approval utilities", "election"_a, "tie_breaking"_a);
+    m.def("mes_apr", &mes_apr, "Method of Equal Shares with approval utilities", "election"_a, "tie_breaking"_a,
+          "num_threads"_a = 1, "log"_a = py::none(), py::call_guard<py::gil_scoped_release>());
 
     m.def("cost_reduction_for_mes_apr", &cost_reduction_for_mes_apr,
           "Cost reduction measure for Method of Equal Shares with approval utilities", "election"_a, "p"_a,
-          "tie_breaking"_a);
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("optimist_add_for_mes_apr", &optimist_add_for_mes_apr,
           "Optimist-add measure for Method of Equal Shares with approval utilities", "election"_a, "p"_a,
-          "tie_breaking"_a);
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("sensitivity_curve_for_mes_apr", &sensitivity_curve_for_mes_apr,
+          "Per-round prices and approvals for Method of Equal Shares with approval utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("pessimist_add_for_mes_apr", &pessimist_add_for_mes_apr,
           "Pessimist-add measure for Method of Equal Shares with approval utilities", "election"_a, "p"_a,
-          "tie_breaking"_a);
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("singleton_add_for_mes_apr", &singleton_add_for_mes_apr,
           "Singleton-add measure for Method of Equal Shares with approval utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("mes_apr_add1", &approval_only<mes_apr_add1, ProjectComparator>,
+          "Method of Equal Shares with approval utilities, completed by increasing voter budgets by 1", "election"_a,
           "tie_breaking"_a);
 
-    m.def("mes_cost", &mes_cost, "Method of Equal Shares with cost utilities", "election"_a, "tie_breaking"_a);
+    m.def("mes_apr_add1u", &approval_only<mes_apr_add1u, ProjectComparator>,
+          "Method of Equal Shares with approval utilities, completed by increasing voter budgets by 1 and then by "
+          "GreedyAV/Cost",
+          "election"_a, "tie_breaking"_a);
+
+    m.def("mes_cost", &mes_cost, "Method of Equal Shares with cost utilities", "election"_a, "tie_breaking"_a,
+          "num_threads"_a = 1, "log"_a = py::none(), py::call_guard<py::gil_scoped_release>());
 
     m.def("cost_reduction_for_mes_cost", &cost_reduction_for_mes_cost,
           "Cost reduction measure for Method of Equal Shares with cost utilities", "election"_a, "p"_a,
-          "tie_breaking"_a);
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("optimist_add_for_mes_cost", &optimist_add_for_mes_cost,
-          "Optimist-add measure for Method of Equal Shares with cost utilities", "election"_a, "p"_a, "tie_breaking"_a);
+          "Optimist-add measure for Method of Equal Shares with cost utilities", "election"_a, "p"_a, "tie_breaking"_a,
+          py::call_guard<py::gil_scoped_release>());
+
+    m.def("sensitivity_curve_for_mes_cost", &sensitivity_curve_for_mes_cost,
+          "Per-round prices and approvals for Method of Equal Shares with cost utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("pessimist_add_for_mes_cost", &pessimist_add_for_mes_cost,
           "Pessimist-add measure for Method of Equal Shares with cost utilities", "election"_a, "p"_a,
-          "tie_breaking"_a);
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("singleton_add_for_mes_cost", &singleton_add_for_mes_cost,
           "Singleton-add measure for Method of Equal Shares with cost utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("mes_cost_add1", &approval_only<mes_cost_add1, ProjectComparator>,
+          "Method of Equal Shares with cost utilities, completed by increasing voter budgets by 1", "election"_a,
           "tie_breaking"_a);
 
-    m.def("phragmen", &phragmen, "Sequential Phragmén", "election"_a, "tie_breaking"_a);
+    m.def("mes_cost_add1u", &approval_only<mes_cost_add1u, ProjectComparator>,
+          "Method of Equal Shares with cost utilities, completed by increasing voter budgets by 1 and then by GreedyAV",
+          "election"_a, "tie_breaking"_a);
+
+    m.def("mes_sqrt_cost", &mes_sqrt_cost, "Method of Equal Shares with square root of cost utilities", "election"_a,
+          "tie_breaking"_a, "num_threads"_a = 1, "log"_a = py::none(), py::call_guard<py::gil_scoped_release>());
+
+    m.def("cost_reduction_for_mes_sqrt_cost", &cost_reduction_for_mes_sqrt_cost,
+          "Cost reduction measure for Method of Equal Shares with square root of cost utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("optimist_add_for_mes_sqrt_cost", &optimist_add_for_mes_sqrt_cost,
+          "Optimist-add measure for Method of Equal Shares with square root of cost utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("sensitivity_curve_for_mes_sqrt_cost", &sensitivity_curve_for_mes_sqrt_cost,
+          "Per-round prices and approvals for Method of Equal Shares with square root of cost utilities", "election"_a,
+          "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("pessimist_add_for_mes_sqrt_cost", &pessimist_add_for_mes_sqrt_cost,
+          "Pessimist-add measure for Method of Equal Shares with square root of cost utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("singleton_add_for_mes_sqrt_cost", &singleton_add_for_mes_sqrt_cost,
+          "Singleton-add measure for Method of Equal Shares with square root of cost utilities", "election"_a, "p"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("phragmen", &phragmen, "Sequential Phragmén", "election"_a, "tie_breaking"_a, "num_threads"_a = 1,
+          "log"_a = py::none(), py::call_guard<py::gil_scoped_release>());
 
     m.def("cost_reduction_for_phragmen", &cost_reduction_for_phragmen, "Cost reduction measure for Sequential Phragmén",
-          "election"_a, "p"_a, "tie_breaking"_a);
+          "election"_a, "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("optimist_add_for_phragmen", &optimist_add_for_phragmen, "Optimist-add measure for Sequential Phragmén",
-          "election"_a, "p"_a, "tie_breaking"_a);
+          "election"_a, "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("sensitivity_curve_for_phragmen", &sensitivity_curve_for_phragmen,
+          "Per-round prices and approvals for Sequential Phragmén", "election"_a, "p"_a, "tie_breaking"_a,
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("pessimist_add_for_phragmen", &pessimist_add_for_phragmen, "Pessimist-add measure for Sequential Phragmén",
-          "election"_a, "p"_a, "tie_breaking"_a);
+          "election"_a, "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 
     m.def("singleton_add_for_phragmen", &singleton_add_for_phragmen, "Singleton-add measure for Sequential Phragmén",
-          "election"_a, "p"_a, "tie_breaking"_a);
+          "election"_a, "p"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    // NumPy result forms: indices of the winners in election.projects and measure values for all projects at once
+
+    m.def(
+        "greedy_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking) {
+            return winner_indices(election, without_gil([&] { return greedy(election, tie_breaking); }));
+        },
+        "Indices of the projects selected by GreedyAV", "election"_a, "tie_breaking"_a);
+
+    m.def(
+        "greedy_over_cost_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking) {
+            return winner_indices(election, without_gil([&] { return greedy_over_cost(election, tie_breaking); }));
+        },
+        "Indices of the projects selected by GreedyAV/Cost", "election"_a, "tie_breaking"_a);
+
+    m.def(
+        "mes_apr_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking, int num_threads, RoundLog *log) {
+            return winner_indices(election,
+                                  without_gil([&] { return mes_apr(election, tie_breaking, num_threads, log); }));
+        },
+        "Indices of the projects selected by Method of Equal Shares with approval utilities", "election"_a,
+        "tie_breaking"_a, "num_threads"_a = 1, "log"_a = py::none());
+
+    m.def(
+        "mes_apr_add1_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking) {
+            return winner_indices(election, approval_only<mes_apr_add1>(election, tie_breaking));
+        },
+        "Indices of the projects selected by Method of Equal Shares with approval utilities, completed by increasing "
+        "voter budgets by 1",
+        "election"_a, "tie_breaking"_a);
+
+    m.def(
+        "mes_apr_add1u_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking) {
+            return winner_indices(election, approval_only<mes_apr_add1u>(election, tie_breaking));
+        },
+        "Indices of the projects selected by Method of Equal Shares with approval utilities, completed by increasing "
+        "voter budgets by 1 and then by GreedyAV/Cost",
+        "election"_a, "tie_breaking"_a);
+
+    m.def(
+        "mes_cost_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking, int num_threads, RoundLog *log) {
+            return winner_indices(election,
+                                  without_gil([&] { return mes_cost(election, tie_breaking, num_threads, log); }));
+        },
+        "Indices of the projects selected by Method of Equal Shares with cost utilities", "election"_a,
+        "tie_breaking"_a, "num_threads"_a = 1, "log"_a = py::none());
+
+    m.def(
+        "mes_cost_add1_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking) {
+            return winner_indices(election, approval_only<mes_cost_add1>(election, tie_breaking));
+        },
+        "Indices of the projects selected by Method of Equal Shares with cost utilities, completed by increasing "
+        "voter budgets by 1",
+        "election"_a, "tie_breaking"_a);
+
+    m.def(
+        "mes_cost_add1u_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking) {
+            return winner_indices(election, approval_only<mes_cost_add1u>(election, tie_breaking));
+        },
+        "Indices of the projects selected by Method of Equal Shares with cost utilities, completed by increasing "
+        "voter budgets by 1 and then by GreedyAV",
+        "election"_a, "tie_breaking"_a);
+
+    m.def(
+        "mes_sqrt_cost_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking, int num_threads, RoundLog *log) {
+            return winner_indices(election,
+                                  without_gil([&] { return mes_sqrt_cost(election, tie_breaking, num_threads, log); }));
+        },
+        "Indices of the projects selected by Method of Equal Shares with square root of cost utilities", "election"_a,
+        "tie_breaking"_a, "num_threads"_a = 1, "log"_a = py::none());
+
+    m.def(
+        "phragmen_indices",
+        [](const Election &election, const ProjectComparator &tie_breaking, int num_threads, RoundLog *log) {
+            return winner_indices(election,
+                                  without_gil([&] { return phragmen(election, tie_breaking, num_threads, log); }));
+        },
+        "Indices of the projects selected by Sequential Phragmén", "election"_a, "tie_breaking"_a,
+        "num_threads"_a = 1, "log"_a = py::none());
+
+    m.def("mes_apr_exact_indices", &exact_winner_indices<mes_apr_exact>,
+          "Indices of the projects selected by Method of Equal Shares with approval utilities in exact arithmetic, "
+          "None on overflow",
+          "election"_a, "tie_breaking"_a);
+
+    m.def("mes_cost_exact_indices", &exact_winner_indices<mes_cost_exact>,
+          "Indices of the projects selected by Method of Equal Shares with cost utilities in exact arithmetic, None on "
+          "overflow",
+          "election"_a, "tie_breaking"_a);
+
+    m.def("phragmen_exact_indices", &exact_winner_indices<phragmen_exact>,
+          "Indices of the projects selected by Sequential Phragmén in exact arithmetic, None on overflow", "election"_a,
+          "tie_breaking"_a);
+
+    def_measure_values<cost_reduction_for_greedy, optimist_add_for_greedy, pessimist_add_for_greedy,
+                       singleton_add_for_greedy>(m, "greedy", "GreedyAV");
+    def_measure_values<cost_reduction_for_greedy_over_cost, optimist_add_for_greedy_over_cost,
+                       pessimist_add_for_greedy_over_cost, singleton_add_for_greedy_over_cost>(m, "greedy_over_cost",
+                                                                                               "GreedyAV/Cost");
+    def_measure_values<cost_reduction_for_mes_apr, optimist_add_for_mes_apr, pessimist_add_for_mes_apr,
+                       singleton_add_for_mes_apr>(m, "mes_apr", "Method of Equal Shares with approval utilities");
+    def_measure_values<cost_reduction_for_mes_cost, optimist_add_for_mes_cost, pessimist_add_for_mes_cost,
+                       singleton_add_for_mes_cost>(m, "mes_cost", "Method of Equal Shares with cost utilities");
+    def_measure_values<cost_reduction_for_mes_sqrt_cost, optimist_add_for_mes_sqrt_cost,
+                       pessimist_add_for_mes_sqrt_cost, singleton_add_for_mes_sqrt_cost>(
+        m, "mes_sqrt_cost", "Method of Equal Shares with square root of cost utilities");
+    def_measure_values<cost_reduction_for_phragmen, optimist_add_for_phragmen, pessimist_add_for_phragmen,
+                       singleton_add_for_phragmen>(m, "phragmen", "Sequential Phragmén");
+
+    // Budget sweeps: winner indices for every budget of a list, the budget of the election is ignored
+
+    m.def("greedy_sweep", &greedy_sweep, "Indices of the projects selected by GreedyAV for every budget", "election"_a,
+          "budgets"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("greedy_over_cost_sweep", &greedy_over_cost_sweep,
+          "Indices of the projects selected by GreedyAV/Cost for every budget", "election"_a, "budgets"_a,
+          "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
+
+    m.def("mes_apr_sweep", &approval_only<mes_apr_sweep, std::vector<long long>, ProjectComparator>,
+          "Indices of the projects selected by Method of Equal Shares with approval utilities for every budget",
+          "election"_a, "budgets"_a, "tie_breaking"_a);
+
+    m.def("mes_cost_sweep", &approval_only<mes_cost_sweep, std::vector<long long>, ProjectComparator>,
+          "Indices of the projects selected by Method of Equal Shares with cost utilities for every budget",
+          "election"_a, "budgets"_a, "tie_breaking"_a);
+
+    m.def("mes_sqrt_cost_sweep", &approval_only<mes_sqrt_cost_sweep, std::vector<long long>, ProjectComparator>,
+          "Indices of the projects selected by Method of Equal Shares with square root of cost utilities for every "
+          "budget",
+          "election"_a, "budgets"_a, "tie_breaking"_a);
+
+    m.def("phragmen_sweep", &phragmen_sweep, "Indices of the projects selected by Sequential Phragmén for every budget",
+          "election"_a, "budgets"_a, "tie_breaking"_a, py::call_guard<py::gil_scoped_release>());
 }
@@ -1,31 +1,101 @@
 from pabumeasures._core import Comparator, Ordering, ProjectComparator
 from pabumeasures.main import (
+    Completion,
+    GreedyTally,
     Measure,
+    MeasureFuture,
+    PreparedElection,
+    Recount,
+    RoundLog,
+    SensitivityPoint,
+    as_completed,
+    attach_election,
+    convert_pabulib,
     greedy,
     greedy_measure,
+    greedy_measure_values,
+    greedy_sweep,
     greedy_over_cost,
     greedy_over_cost_measure,
+    greedy_over_cost_measure_values,
+    greedy_over_cost_sweep,
+    load_election,
     mes_apr,
     mes_apr_measure,
+    mes_apr_measure_values,
+    mes_apr_sensitivity_curve,
+    mes_apr_sweep,
     mes_cost,
     mes_cost_measure,
+    mes_cost_measure_values,
+    mes_cost_sensitivity_curve,
+    mes_cost_sweep,
+    mes_sqrt_cost,
+    mes_sqrt_cost_measure,
+    mes_sqrt_cost_measure_values,
+    mes_sqrt_cost_sensitivity_curve,
+    mes_sqrt_cost_sweep,
     phragmen,
     phragmen_measure,
+    phragmen_measure_values,
+    phragmen_sensitivity_curve,
+    phragmen_sweep,
+    run_async,
+    save_election,
+    selection_frequencies,
+    share_election,
+    submit,
+    unlink_shared_election,
 )
 
 __all__ = [
+    "Completion",
+    "GreedyTally",
     "Measure",
+    "MeasureFuture",
+    "PreparedElection",
+    "Recount",
+    "RoundLog",
+    "SensitivityPoint",
     "Comparator",
     "Ordering",
     "ProjectComparator",
+    "as_completed",
+    "attach_election",
+    "convert_pabulib",
     "greedy",
     "greedy_measure",
+    "greedy_measure_values",
+    "greedy_sweep",
     "greedy_over_cost",
     "greedy_over_cost_measure",
+    "greedy_over_cost_measure_values",
+    "greedy_over_cost_sweep",
+    "load_election",
     "mes_apr",
     "mes_apr_measure",
+    "mes_apr_measure_values",
+    "mes_apr_sensitivity_curve",
+    "mes_apr_sweep",
     "mes_cost",
     "mes_cost_measure",
+    "mes_cost_measure_values",
+    "mes_cost_sensitivity_curve",
+    "mes_cost_sweep",
+    "mes_sqrt_cost",
+    "mes_sqrt_cost_measure",
+    "mes_sqrt_cost_measure_values",
+    "mes_sqrt_cost_sensitivity_curve",
+    "mes_sqrt_cost_sweep",
     "phragmen",
     "phragmen_measure",
+    "phragmen_measure_values",
+    "phragmen_sensitivity_curve",
+    "phragmen_sweep",
+    "run_async",
+    "save_election",
+    "selection_frequencies",
+    "share_election",
+    "submit",
+    "unlink_shared_election",
 ]
@@ -1,6 +1,9 @@
 import enum
 from typing import overload
 
+import numpy as np
+import numpy.typing as npt
+
 # ========== project enums ==========
 
 class Comparator(enum.Enum):
@@ -15,24 +18,39 @@ class Ordering(enum.Enum):
 # ========== project classes ==========
 
 class Election:
+    @overload
     def __init__(self, budget: int, num_of_voters: int, projects: list[ProjectEmbedding]) -> None: ...
+    @overload
+    def __init__(self, budget: int, voter_weights: list[int], projects: list[ProjectEmbedding]) -> None: ...
+    def __init__(self, *args, **kwargs) -> None: ...
     @property
     def budget(self) -> int: ...
     @property
     def num_of_voters(self) -> int: ...
     @property
+    def num_of_voter_classes(self) -> int: ...
+    @property
+    def voter_weights(self) -> list[int]: ...
+    @property
     def projects(self) -> list[ProjectEmbedding]: ...
 
 class ProjectEmbedding:
+    @overload
     def __init__(self, cost: int, name: str, approvers: list[int] = ...) -> None: ...
+    @overload
+    def __init__(self, cost: int, name: str, approvers: list[int], utilities: list[int]) -> None: ...
     @property
     def cost(self) -> int: ...
     @property
     def name(self) -> str: ...
     @property
-    def approvers(self) -> list[int]: ...
+    def approvers(self) -> npt.NDArray[np.intc]: ...
+    @property
+    def utilities(self) -> npt.NDArray[np.int64]: ...
     @property
     def num_of_approvers(self) -> int: ...
+    @property
+    def score(self) -> int: ...
 
 class ProjectComparator:
     ByCostAsc: ProjectComparator
@@ -49,14 +67,113 @@ class ProjectComparator:
     def __init__(self, comparator: Comparator, ordering: Ordering) -> None: ...
     def __init__(self, *args, **kwargs) -> None: ...
     def __call__(self, lhs: ProjectEmbedding, rhs: ProjectEmbedding) -> bool: ...
+    @property
+    def criteria(self) -> list[tuple[Comparator, Ordering]]: ...
+
+class SensitivityPoint:
+    @property
+    def winner(self) -> int: ...
+    @property
+    def price(self) -> int: ...
+    @property
+    def added_approvers(self) -> int | None: ...
+
+class RoundLog:
+    def __init__(self) -> None: ...
+    @property
+    def winners(self) -> npt.NDArray[np.intc]: ...
+    @property
+    def prices(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def payment_offsets(self) -> npt.NDArray[np.int64]: ...
+    @property
+    def payment_voter_classes(self) -> npt.NDArray[np.intc]: ...
+    @property
+    def payment_amounts(self) -> npt.NDArray[np.float64]: ...
+
+class GreedyTally:
+    def __init__(self, election: Election, tie_breaking: ProjectComparator, over_cost: bool) -> None: ...
+    def add_ballot(self, approved: list[int]) -> None: ...
+    def retract_ballot(self, approved: list[int]) -> None: ...
+    def allocation(self) -> list[int]: ...
+    def cost_reduction(self, p: int) -> int: ...
+
+class RecountRule(enum.Enum):
+    MES_APR: RecountRule
+    MES_COST: RecountRule
+    PHRAGMEN: RecountRule
+
+class Recount:
+    def __init__(self, election: Election, rule: RecountRule, tie_breaking: ProjectComparator) -> None: ...
+    def set_weight(self, voter_class: int, weight: int) -> None: ...
+    def add_voter_class(self, approved: list[int], weight: int) -> int: ...
+    def winners(self) -> list[int]: ...
+    @property
+    def resumed_round(self) -> int: ...
+
+class SampledRule(enum.Enum):
+    GREEDY: SampledRule
+    GREEDY_OVER_COST: SampledRule
+    MES_APR: SampledRule
+    MES_COST: SampledRule
+    PHRAGMEN: SampledRule
+
+class Resampling(enum.Enum):
+    BOOTSTRAP: Resampling
+    DROP: Resampling
+
+def selection_frequencies(
+    election: Election,
+    rule: SampledRule,
+    resampling: Resampling,
+    drop_fraction: float,
+    num_samples: int,
+    seed: int,
+    tie_breaking: ProjectComparator,
+    num_threads: int = 1,
+) -> npt.NDArray[np.float64]: ...
+
+def save_election(election: Election, path: str) -> bool: ...
+def load_election(path: str) -> Election | None: ...
+def share_election(election: Election, name: str) -> bool: ...
+def attach_election(name: str) -> Election | None: ...
+def unlink_shared_election(name: str) -> bool: ...
+
+# ========== cancellation ==========
+
+class CancellationToken:
+    def __init__(self) -> None: ...
+    def cancel(self) -> None: ...
+    @property
+    def cancelled(self) -> bool: ...
+    def __enter__(self) -> CancellationToken: ...
+    def __exit__(self, *args: object) -> None: ...
+
+def cancellation_requested() -> bool: ...
 
 # ========== rules ==========
 
 def greedy(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
 def greedy_over_cost(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
-def mes_apr(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
-def mes_cost(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
-def phragmen(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
+def mes_apr(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> list[ProjectEmbedding]: ...
+def mes_cost(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> list[ProjectEmbedding]: ...
+def mes_sqrt_cost(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> list[ProjectEmbedding]: ...
+def phragmen(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> list[ProjectEmbedding]: ...
+
+# ========== completions ==========
+
+def mes_apr_add1(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
+def mes_apr_add1u(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
+def mes_cost_add1(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
+def mes_cost_add1u(election: Election, tie_breaking: ProjectComparator) -> list[ProjectEmbedding]: ...
 
 # ========== optimist-add ==========
 
@@ -64,6 +181,7 @@ def optimist_add_for_greedy(election: Election, p: int, tie_breaking: ProjectCom
 def optimist_add_for_greedy_over_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def optimist_add_for_mes_apr(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def optimist_add_for_mes_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
+def optimist_add_for_mes_sqrt_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def optimist_add_for_phragmen(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 
 # ========== pessimist-add ==========
@@ -72,6 +190,7 @@ def pessimist_add_for_greedy(election: Election, p: int, tie_breaking: ProjectCo
 def pessimist_add_for_greedy_over_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def pessimist_add_for_mes_apr(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def pessimist_add_for_mes_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
+def pessimist_add_for_mes_sqrt_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def pessimist_add_for_phragmen(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 
 # ========== singleton-add ==========
@@ -80,6 +199,7 @@ def singleton_add_for_greedy(election: Election, p: int, tie_breaking: ProjectCo
 def singleton_add_for_greedy_over_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def singleton_add_for_mes_apr(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def singleton_add_for_mes_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
+def singleton_add_for_mes_sqrt_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 def singleton_add_for_phragmen(election: Election, p: int, tie_breaking: ProjectComparator) -> int | None: ...
 
 # ========== cost-reduction ==========
@@ -88,4 +208,107 @@ def cost_reduction_for_greedy(election: Election, p: int, tie_breaking: ProjectC
 def cost_reduction_for_greedy_over_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int: ...
 def cost_reduction_for_mes_apr(election: Election, p: int, tie_breaking: ProjectComparator) -> int: ...
 def cost_reduction_for_mes_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int: ...
+def cost_reduction_for_mes_sqrt_cost(election: Election, p: int, tie_breaking: ProjectComparator) -> int: ...
 def cost_reduction_for_phragmen(election: Election, p: int, tie_breaking: ProjectComparator) -> int: ...
+
+# ========== sensitivity curves ==========
+
+def sensitivity_curve_for_mes_apr(
+    election: Election, p: int, tie_breaking: ProjectComparator
+) -> list[SensitivityPoint]: ...
+def sensitivity_curve_for_mes_cost(
+    election: Election, p: int, tie_breaking: ProjectComparator
+) -> list[SensitivityPoint]: ...
+def sensitivity_curve_for_mes_sqrt_cost(
+    election: Election, p: int, tie_breaking: ProjectComparator
+) -> list[SensitivityPoint]: ...
+def sensitivity_curve_for_phragmen(
+    election: Election, p: int, tie_breaking: ProjectComparator
+) -> list[SensitivityPoint]: ...
+
+# ========== NumPy result forms ==========
+# indices of the winners in Election.projects; measure values for every project, -1 where a measure returns None
+
+def greedy_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc]: ...
+def greedy_over_cost_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc]: ...
+def mes_apr_indices(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> npt.NDArray[np.intc]: ...
+def mes_apr_add1_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc]: ...
+def mes_apr_add1u_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc]: ...
+def mes_cost_indices(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> npt.NDArray[np.intc]: ...
+def mes_cost_add1_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc]: ...
+def mes_cost_add1u_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc]: ...
+def mes_sqrt_cost_indices(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> npt.NDArray[np.intc]: ...
+def phragmen_indices(
+    election: Election, tie_breaking: ProjectComparator, num_threads: int = 1, log: RoundLog | None = None
+) -> npt.NDArray[np.intc]: ...
+def mes_apr_exact_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc] | None: ...
+def mes_cost_exact_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc] | None: ...
+def phragmen_exact_indices(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.intc] | None: ...
+
+def optimist_add_for_greedy_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def optimist_add_for_greedy_over_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def optimist_add_for_mes_apr_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def optimist_add_for_mes_cost_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def optimist_add_for_mes_sqrt_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def optimist_add_for_phragmen_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+
+def pessimist_add_for_greedy_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def pessimist_add_for_greedy_over_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def pessimist_add_for_mes_apr_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def pessimist_add_for_mes_cost_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def pessimist_add_for_mes_sqrt_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def pessimist_add_for_phragmen_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+
+def singleton_add_for_greedy_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def singleton_add_for_greedy_over_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def singleton_add_for_mes_apr_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def singleton_add_for_mes_cost_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def singleton_add_for_mes_sqrt_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def singleton_add_for_phragmen_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+
+def cost_reduction_for_greedy_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def cost_reduction_for_greedy_over_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def cost_reduction_for_mes_apr_values(election: Election, tie_breaking: ProjectComparator) -> npt.NDArray[np.int64]: ...
+def cost_reduction_for_mes_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def cost_reduction_for_mes_sqrt_cost_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+def cost_reduction_for_phragmen_values(
+    election: Election, tie_breaking: ProjectComparator
+) -> npt.NDArray[np.int64]: ...
+
+# ========== budget sweeps ==========
+# indices of the winners in Election.projects for every budget, the budget of the election is ignored
+
+def greedy_sweep(election: Election, budgets: list[int], tie_breaking: ProjectComparator) -> list[list[int]]: ...
+def greedy_over_cost_sweep(
+    election: Election, budgets: list[int], tie_breaking: ProjectComparator
+) -> list[list[int]]: ...
+def mes_apr_sweep(election: Election, budgets: list[int], tie_breaking: ProjectComparator) -> list[list[int]]: ...
+def mes_cost_sweep(election: Election, budgets: list[int], tie_breaking: ProjectComparator) -> list[list[int]]: ...
+def mes_sqrt_cost_sweep(
+    election: Election, budgets: list[int], tie_breaking: ProjectComparator
+) -> list[list[int]]: ...
+def phragmen_sweep(election: Election, budgets: list[int], tie_breaking: ProjectComparator) -> list[list[int]]: ...
@@ -1,8 +1,20 @@
+import asyncio
+from collections import Counter
+from collections.abc import Callable, Iterable, Iterator
+from concurrent.futures import CancelledError, Future, ThreadPoolExecutor
+from concurrent.futures import as_completed as _as_completed
+from concurrent.futures._base import CANCELLED_AND_NOTIFIED
+from dataclasses import dataclass
 from enum import Enum, auto
+from os import PathLike, cpu_count, fspath
+from threading import Lock
+from typing import Any
 
-from pabutools.election.ballot import FrozenBallot
+import numpy as np
+import numpy.typing as npt
 from pabutools.election.instance import Instance, Project
-from pabutools.election.profile import ApprovalProfile, Profile
+from pabutools.election.pabulib import parse_pabulib
+from pabutools.election.profile import ApprovalProfile, CardinalProfile, Profile
 from pabutools.rules import BudgetAllocation
 
 from pabumeasures import ProjectComparator, _core
@@ -15,15 +27,61 @@ class Measure(Enum):
     ADD_SINGLETON = auto()
 
 
-def _translate_input_format(instance: Instance, profile: Profile) -> tuple[_core.Election, dict[str, Project]]:
+class Completion(Enum):
+    ADD1 = auto()
+    ADD1U = auto()
+
+
+# One round of a rule, seen from a fixed project: the project selected in this round (None once no project is
+# affordable), the largest cost at which the fixed project would be selected instead (0 if none) and the fewest new
+# approvers it would need to be selected instead (None if no number suffices).
+@dataclass(frozen=True)
+class SensitivityPoint:
+    winner: Project | None
+    price: int
+    added_approvers: int | None
+
+
+# Columnar record of the rounds of mes_apr, mes_cost, mes_sqrt_cost or phragmen, filled in when passed as their log
+# argument. Round r selects projects[winners[r]] at prices[r] (MES: the max payment per unit of utility, Phragmén: the
+# new load of the winner's approvers). Its payments are the entries payment_offsets[r] to payment_offsets[r + 1] - 1
+# of payment_voter_classes and payment_amounts: what every voter of the class paid (MES), or the load it took on
+# (Phragmén). voter_classes gives the voter class of every ballot of the profile. The columns are read-only NumPy
+# views of the buffers written by the rule (the offsets are those of an Arrow large list). Every run writes to new
+# buffers, so columns read before a later run keep describing the earlier one.
+class RoundLog:
+    def __init__(self) -> None:
+        self._log = _core.RoundLog()
+        self._filling = Lock()
+        self.projects: list[Project] = []
+        self.voter_classes: npt.NDArray[np.intc] = np.empty(0, dtype=np.intc)
+
+    @property
+    def winners(self) -> npt.NDArray[np.intc]:
+        return self._log.winners
+
+    @property
+    def prices(self) -> npt.NDArray[np.float64]:
+        return self._log.prices
+
+    @property
+    def payment_offsets(self) -> npt.NDArray[np.int64]:
+        return self._log.payment_offsets
+
+    @property
+    def payment_voter_classes(self) -> npt.NDArray[np.intc]:
+        return self._log.payment_voter_classes
+
+    @property
+    def payment_amounts(self) -> npt.NDArray[np.float64]:
+        return self._log.payment_amounts
+
+
+def _translate_instance(instance: Instance) -> list[Project]:
     if not isinstance(instance, Instance):
         raise TypeError("Instance must be of type Instance")
-    if not isinstance(profile, ApprovalProfile):
-        raise TypeError("Profile must be of type ApprovalProfile")
     if len(instance) == 0:
         raise ValueError("Instance must contain at least one project")
-    if len(profile) == 0:
-        raise ValueError("Profile must contain at least one ballot")
     if len([project.name for project in instance]) != len({project.name for project in instance}):
         raise ValueError("Project names must be unique in the instance")
     if any(project.cost <= 0 for project in instance):
@@ -32,156 +90,960 @@ def _translate_input_format(instance: Instance, profile: Profile) -> tuple[_core
         raise ValueError("Project costs must not exceed the budget limit")
     if instance.budget_limit > 1_000_000_000:
         raise ValueError("Budget limit must not exceed 1 billion")
+    return sorted(instance)
+
+
+# Voters with identical ballots are merged into a single weighted voter class: the approved project names of every
+# class with its number of voters, in order of first appearance.
+def _voter_classes(profile: ApprovalProfile) -> dict[frozenset[str], int]:
+    voter_weights: dict[frozenset[str], int] = {}
+    for ballot in profile:
+        approved_names = frozenset(project.name for project in ballot)
+        voter_weights[approved_names] = voter_weights.get(approved_names, 0) + 1
+    return voter_weights
+
+
+# Cardinal ballots (e.g. cumulative or scoring) are merged in the same way, with the utility of every project of the
+# ballot; projects with utility 0 are left out, as they are not approved.
+def _cardinal_voter_classes(profile: CardinalProfile) -> dict[frozenset[tuple[str, int]], int]:
+    voter_weights: dict[frozenset[tuple[str, int]], int] = {}
+    for ballot in profile:
+        if any(utility < 0 or utility != int(utility) for utility in ballot.values()):
+            raise ValueError("Ballot utilities must be non-negative integers")
+        if any(utility > 1_000_000_000 for utility in ballot.values()):
+            raise ValueError("Ballot utilities must not exceed 1 billion")
+        utilities = frozenset((project.name, int(utility)) for project, utility in ballot.items() if utility > 0)
+        voter_weights[utilities] = voter_weights.get(utilities, 0) + 1
+    return voter_weights
+
+
+def _translate_approval_profile(
+    instance: Instance, profile: ApprovalProfile, projects: list[Project]
+) -> _core.Election:
+    if len(profile) == 0:
+        raise ValueError("Profile must contain at least one ballot")
 
-    projects: list[Project] = sorted(instance)
-    frozen_ballots: list[tuple[int, FrozenBallot]] = [(i, ballot.frozen()) for i, ballot in enumerate(profile)]
     total_budget = int(instance.budget_limit)
+    voter_weights = _voter_classes(profile)
     approvers: dict[str, list[int]] = {project.name: [] for project in projects}
-    for i, frozen_ballot in frozen_ballots:
-        for project in frozen_ballot:
-            approvers[project.name].append(i)
+    for voter_class, approved_names in enumerate(voter_weights):
+        for name in approved_names:
+            approvers[name].append(voter_class)
     project_embeddings: list[_core.ProjectEmbedding] = [
         _core.ProjectEmbedding(int(project.cost), project.name, approvers[project.name]) for project in projects
     ]
-    name_to_project: dict[str, Project] = {project.name: project for project in projects}
-    return _core.Election(total_budget, len(profile), project_embeddings), name_to_project
+    return _core.Election(total_budget, list(voter_weights.values()), project_embeddings)
+
+
+def _translate_cardinal_profile(
+    instance: Instance, profile: CardinalProfile, projects: list[Project]
+) -> _core.Election:
+    if len(profile) == 0:
+        raise ValueError("Profile must contain at least one ballot")
+
+    voter_weights = _cardinal_voter_classes(profile)
+    approvers: dict[str, list[int]] = {project.name: [] for project in projects}
+    utilities: dict[str, list[int]] = {project.name: [] for project in projects}
+    for voter_class, ballot_utilities in enumerate(voter_weights):
+        for name, utility in ballot_utilities:
+            approvers[name].append(voter_class)
+            utilities[name].append(utility)
+    project_embeddings: list[_core.ProjectEmbedding] = [
+        _core.ProjectEmbedding(int(project.cost), project.name, approvers[project.name], utilities[project.name])
+        for project in projects
+    ]
+    return _core.Election(int(instance.budget_limit), list(voter_weights.values()), project_embeddings)
+
+
+# Voter class of every ballot, numbered as by _voter_classes and _cardinal_voter_classes.
+def _ballot_voter_classes(profile: Profile) -> npt.NDArray[np.intc]:
+    if isinstance(profile, CardinalProfile):
+        keys = [
+            frozenset((project.name, int(utility)) for project, utility in ballot.items() if utility > 0)
+            for ballot in profile
+        ]
+    else:
+        keys = [frozenset(project.name for project in ballot) for ballot in profile]
+    class_of: dict[frozenset, int] = {}
+    return np.array([class_of.setdefault(key, len(class_of)) for key in keys], dtype=np.intc)
+
+
+# An election translated once, to be passed in place of the instance to the rules and measures, with the profile left
+# out (or None). Besides the core election and the position of every project in sorted(instance), it keeps what is
+# derived from them when first needed: the voter class of every ballot, and the allocations and measures already
+# computed, keyed by the rule and tie-breaking, which are deterministic. Notebooks calling many rules and measures on
+# one election then translate it once. The instance and profile must not change afterwards.
+class PreparedElection:
+    def __init__(self, instance: Instance, profile: Profile):
+        projects = _translate_instance(instance)
+        if isinstance(profile, CardinalProfile):
+            election = _translate_cardinal_profile(instance, profile, projects)
+        elif isinstance(profile, ApprovalProfile):
+            election = _translate_approval_profile(instance, profile, projects)
+        else:
+            raise TypeError("Profile must be of type ApprovalProfile or CardinalProfile")
+        self._init(instance, profile, election, projects, isinstance(profile, CardinalProfile))
+
+    def _init(
+        self,
+        instance: Instance,
+        profile: Profile | None,
+        election: _core.Election,
+        projects: list[Project],
+        cardinal: bool,
+    ) -> None:
+        self.instance = instance
+        self.profile = profile
+        self.election = election
+        self.projects = projects
+        self.cardinal = cardinal
+        self._index = {project.name: i for i, project in enumerate(projects)}
+        self._voter_classes: npt.NDArray[np.intc] | None = None
+        self._cache: dict[tuple, Any] = {}
+
+    # Election of a file written by save_election or convert_pabulib. Its instance has projects with the names and costs
+    # of the file, and as there is no profile, the ballots of a round log are numbered voter class by voter class.
+    @classmethod
+    def load(cls, path: str | PathLike[str]) -> "PreparedElection":
+        return cls._from_election(load_election(path))
+
+    # Election shared by share_election, like load.
+    @classmethod
+    def attach(cls, name: str) -> "PreparedElection":
+        return cls._from_election(attach_election(name))
+
+    @classmethod
+    def _from_election(cls, election: _core.Election) -> "PreparedElection":
+        embeddings = election.projects
+        projects = [Project(project.name, project.cost) for project in embeddings]
+        prepared = cls.__new__(cls)
+        cardinal = any(len(project.utilities) > 0 for project in embeddings)
+        prepared._init(Instance(projects, budget_limit=election.budget), None, election, projects, cardinal)
+        return prepared
+
+    def index(self, project: Project) -> int:
+        if project.name not in self._index:
+            raise ValueError("Project must be in the instance")
+        return self._index[project.name]
+
+    @property
+    def voter_classes(self) -> npt.NDArray[np.intc]:
+        if self._voter_classes is None:
+            if self.profile is None:
+                weights = self.election.voter_weights
+                self._voter_classes = np.repeat(np.arange(len(weights), dtype=np.intc), weights)
+            else:
+                self._voter_classes = _ballot_voter_classes(self.profile)
+        return self._voter_classes
+
+    def _cached(self, key: tuple, compute: Callable[[], Any]) -> Any:
+        if key not in self._cache:
+            self._store(key, compute())
+        return self._cache[key]
+
+    # A computation cancelled by its future stopped early with a meaningless result, which must not be remembered.
+    def _store(self, key: tuple, value: Any) -> None:
+        if _core.cancellation_requested():
+            raise CancelledError()
+        self._cache[key] = value
+
+    # Allocation of the core rule, which returns the indices of the winners; extra arguments (the number of threads)
+    # must not change them. The rule always runs when it is to fill in a round log.
+    def _allocation(
+        self, rule: Callable[..., Any], tie_breaking: ProjectComparator, *args: Any, log: RoundLog | None = None
+    ) -> BudgetAllocation:
+        key = (rule.__name__, tuple(tie_breaking.criteria))
+        if log is not None:
+            self._store(key, _fill_log(log, self, lambda core_log: rule(self.election, tie_breaking, *args, core_log)))
+        result = self._cached(key, lambda: rule(self.election, tie_breaking, *args))
+        if result is None:
+            raise OverflowError("Exact arithmetic overflowed 128-bit integers, use exact=False")
+        return BudgetAllocation(self.projects[i] for i in result)
+
+    # Single measures are read from the values of all projects if those have been computed.
+    def _measure(self, measure: Callable[..., Any], project: Project, tie_breaking: ProjectComparator) -> int | None:
+        p = self.index(project)
+        criteria = tuple(tie_breaking.criteria)
+        values = self._cache.get((measure.__name__ + "_values", criteria))
+        if values is not None:
+            return None if values[p] == -1 else int(values[p])
+        return self._cached((measure.__name__, p, criteria), lambda: measure(self.election, p, tie_breaking))
+
+    def _measure_values(
+        self, measure_values: Callable[..., Any], tie_breaking: ProjectComparator
+    ) -> npt.NDArray[np.int64]:
+        key = (measure_values.__name__, tuple(tie_breaking.criteria))
+        return self._cached(key, lambda: measure_values(self.election, tie_breaking)).copy()
+
+
+# The prepared election of the arguments of a public function: instance itself if it is a PreparedElection, with no
+# profile. With allow_cardinal, cardinal profiles are accepted as well, their ballot utilities taking the place of
+# approvals.
+def _prepare(
+    instance: Instance | PreparedElection, profile: Profile | None, allow_cardinal: bool = False
+) -> PreparedElection:
+    if isinstance(instance, PreparedElection):
+        if profile is not None:
+            raise TypeError("Profile must be left out when passing a PreparedElection")
+        prepared = instance
+    else:
+        prepared = PreparedElection(instance, profile)
+    if prepared.cardinal and not allow_cardinal:
+        raise TypeError("Profile must be of type ApprovalProfile")
+    return prepared
+
+
+# Result of run, which fills in a new core log that then replaces the one of log. The rule releases the GIL while it
+# appends to the core log, so NumPy views of a log being filled would point at buffers that may be reallocated; the
+# views of the replaced log keep it alive instead. A log is filled by one call at a time.
+def _fill_log(log: RoundLog, prepared: PreparedElection, run: Callable[[_core.RoundLog], Any]) -> Any:
+    if not isinstance(log, RoundLog):
+        raise TypeError("Log must be of type RoundLog")
+    if not log._filling.acquire(blocking=False):
+        raise ValueError("Round log is already being filled by another call")
+    try:
+        core_log = _core.RoundLog()
+        result = run(core_log)
+        if _core.cancellation_requested():  # the rule stopped early, the log of the previous run stays
+            raise CancelledError()
+        log._log, log.projects, log.voter_classes = core_log, prepared.projects, prepared.voter_classes
+        return result
+    finally:
+        log._filling.release()
+
+
+def _check_log(log: RoundLog | None, completion: Completion | None, exact: bool) -> None:
+    if log is not None and (completion is not None or exact):
+        raise ValueError("Round logs are not supported with completions or exact arithmetic")
+
+
+def _translate_budgets(budgets: list[int]) -> list[int]:
+    if any(budget <= 0 for budget in budgets):
+        raise ValueError("Budgets must be positive")
+    if any(budget > 1_000_000_000 for budget in budgets):
+        raise ValueError("Budgets must not exceed 1 billion")
+    return [int(budget) for budget in budgets]
+
+
+def _check_exact_completion(completion: Completion | None) -> None:
+    if completion is not None:
+        raise ValueError("Exact arithmetic is not supported with completions")
+
+
+def _translate_allocations(allocations: list[list[int]], projects: list[Project]) -> list[BudgetAllocation]:
+    return [BudgetAllocation(projects[i] for i in allocation) for allocation in allocations]
+
+
+def _translate_curve(curve: list[_core.SensitivityPoint], projects: list[Project]) -> list[SensitivityPoint]:
+    return [
+        SensitivityPoint(projects[point.winner] if point.winner >= 0 else None, point.price, point.added_approvers)
+        for point in curve
+    ]
 
 
 def greedy(
-    instance: Instance, profile: Profile, tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc
+    instance: Instance | PreparedElection,
+    profile: Profile | None = None,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
 ) -> BudgetAllocation:
-    election, name_to_project = _translate_input_format(instance, profile)
-    result = _core.greedy(election, tie_breaking)
-    return BudgetAllocation(name_to_project[project_embeding.name] for project_embeding in result)
+    prepared = _prepare(instance, profile, allow_cardinal=True)
+    return prepared._allocation(_core.greedy_indices, tie_breaking)
+
+
+def greedy_sweep(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    budgets: list[int],
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[BudgetAllocation]:
+    prepared = _prepare(instance, profile)
+    allocations = _core.greedy_sweep(prepared.election, _translate_budgets(budgets), tie_breaking)
+    return _translate_allocations(allocations, prepared.projects)
 
 
 def greedy_measure(
-    instance: Instance,
-    profile: Profile,
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
     project: Project,
     measure: Measure,
     tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
 ) -> int | None:
-    election, _ = _translate_input_format(instance, profile)
-    p = sorted(instance).index(project)
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
     match measure:
         case Measure.COST_REDUCTION:
-            return _core.cost_reduction_for_greedy(election, p, tie_breaking)
+            return prepared._measure(_core.cost_reduction_for_greedy, project, tie_breaking)
         case Measure.ADD_APPROVAL_OPTIMIST:
-            return _core.optimist_add_for_greedy(election, p, tie_breaking)
+            return prepared._measure(_core.optimist_add_for_greedy, project, tie_breaking)
         case Measure.ADD_APPROVAL_PESSIMIST:
-            return _core.pessimist_add_for_greedy(election, p, tie_breaking)
+            return prepared._measure(_core.pessimist_add_for_greedy, project, tie_breaking)
         case Measure.ADD_SINGLETON:
-            return _core.singleton_add_for_greedy(election, p, tie_breaking)
+            return prepared._measure(_core.singleton_add_for_greedy, project, tie_breaking)
+
+
+def greedy_measure_values(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    measure: Measure,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> npt.NDArray[np.int64]:
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
+    match measure:
+        case Measure.COST_REDUCTION:
+            return prepared._measure_values(_core.cost_reduction_for_greedy_values, tie_breaking)
+        case Measure.ADD_APPROVAL_OPTIMIST:
+            return prepared._measure_values(_core.optimist_add_for_greedy_values, tie_breaking)
+        case Measure.ADD_APPROVAL_PESSIMIST:
+            return prepared._measure_values(_core.pessimist_add_for_greedy_values, tie_breaking)
+        case Measure.ADD_SINGLETON:
+            return prepared._measure_values(_core.singleton_add_for_greedy_values, tie_breaking)
 
 
 def greedy_over_cost(
-    instance: Instance, profile: Profile, tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc
+    instance: Instance | PreparedElection,
+    profile: Profile | None = None,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
 ) -> BudgetAllocation:
-    election, name_to_project = _translate_input_format(instance, profile)
-    result = _core.greedy_over_cost(election, tie_breaking)
-    return BudgetAllocation(name_to_project[project_embeding.name] for project_embeding in result)
+    prepared = _prepare(instance, profile, allow_cardinal=True)
+    return prepared._allocation(_core.greedy_over_cost_indices, tie_breaking)
+
+
+def greedy_over_cost_sweep(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    budgets: list[int],
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[BudgetAllocation]:
+    prepared = _prepare(instance, profile)
+    allocations = _core.greedy_over_cost_sweep(prepared.election, _translate_budgets(budgets), tie_breaking)
+    return _translate_allocations(allocations, prepared.projects)
 
 
 def greedy_over_cost_measure(
-    instance: Instance,
-    profile: Profile,
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
     project: Project,
     measure: Measure,
     tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
 ) -> int | None:
-    election, _ = _translate_input_format(instance, profile)
-    p = sorted(instance).index(project)
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
+    match measure:
+        case Measure.COST_REDUCTION:
+            return prepared._measure(_core.cost_reduction_for_greedy_over_cost, project, tie_breaking)
+        case Measure.ADD_APPROVAL_OPTIMIST:
+            return prepared._measure(_core.optimist_add_for_greedy_over_cost, project, tie_breaking)
+        case Measure.ADD_APPROVAL_PESSIMIST:
+            return prepared._measure(_core.pessimist_add_for_greedy_over_cost, project, tie_breaking)
+        case Measure.ADD_SINGLETON:
+            return prepared._measure(_core.singleton_add_for_greedy_over_cost, project, tie_breaking)
+
+
+def greedy_over_cost_measure_values(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    measure: Measure,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> npt.NDArray[np.int64]:
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
     match measure:
         case Measure.COST_REDUCTION:
-            return _core.cost_reduction_for_greedy_over_cost(election, p, tie_breaking)
+            return prepared._measure_values(_core.cost_reduction_for_greedy_over_cost_values, tie_breaking)
         case Measure.ADD_APPROVAL_OPTIMIST:
-            return _core.optimist_add_for_greedy_over_cost(election, p, tie_breaking)
+            return prepared._measure_values(_core.optimist_add_for_greedy_over_cost_values, tie_breaking)
         case Measure.ADD_APPROVAL_PESSIMIST:
-            return _core.pessimist_add_for_greedy_over_cost(election, p, tie_breaking)
+            return prepared._measure_values(_core.pessimist_add_for_greedy_over_cost_values, tie_breaking)
         case Measure.ADD_SINGLETON:
-            return _core.singleton_add_for_greedy_over_cost(election, p, tie_breaking)
+            return prepared._measure_values(_core.singleton_add_for_greedy_over_cost_values, tie_breaking)
+
+
+# Approval counts of an ongoing vote, giving GreedyAV (or GreedyAV/Cost if over_cost) results after every ballot.
+# Ballots are added and retracted one at a time, in O(k log m) for a ballot approving k of the m projects, and the
+# allocation and the cost reduction measure are available at any moment without re-reading the profile.
+class GreedyTally:
+    def __init__(
+        self,
+        instance: Instance,
+        profile: ApprovalProfile | None = None,
+        over_cost: bool = False,
+        tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+    ):
+        self._projects = _translate_instance(instance)
+        if profile is not None and not isinstance(profile, ApprovalProfile):
+            raise TypeError("Profile must be of type ApprovalProfile")
+        self._index = {project.name: i for i, project in enumerate(self._projects)}
+        self._ballots: Counter[frozenset[int]] = Counter()
+        project_embeddings = [_core.ProjectEmbedding(int(project.cost), project.name, []) for project in self._projects]
+        self._tally = _core.GreedyTally(
+            _core.Election(int(instance.budget_limit), 0, project_embeddings), tie_breaking, over_cost
+        )
+        for ballot in profile if profile is not None else []:
+            self.add_ballot(ballot)
+
+    def _translate_ballot(self, ballot: Iterable[Project]) -> frozenset[int]:
+        if any(project.name not in self._index for project in ballot):
+            raise ValueError("Ballot must only approve projects of the instance")
+        return frozenset(self._index[project.name] for project in ballot)
+
+    def add_ballot(self, ballot: Iterable[Project]) -> None:
+        approved = self._translate_ballot(ballot)
+        self._ballots[approved] += 1
+        self._tally.add_ballot(list(approved))
+
+    def retract_ballot(self, ballot: Iterable[Project]) -> None:
+        approved = self._translate_ballot(ballot)
+        if self._ballots[approved] == 0:
+            raise ValueError("Ballot must have been added before it is retracted")
+        self._ballots[approved] -= 1
+        self._tally.retract_ballot(list(approved))
+
+    def allocation(self) -> BudgetAllocation:
+        return BudgetAllocation(self._projects[i] for i in self._tally.allocation())
+
+    def cost_reduction(self, project: Project) -> int:
+        return self._tally.cost_reduction(self._index[project.name])
 
 
 def mes_apr(
-    instance: Instance, profile: Profile, tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc
+    instance: Instance | PreparedElection,
+    profile: Profile | None = None,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+    completion: Completion | None = None,
+    num_threads: int = 1,
+    exact: bool = False,
+    log: RoundLog | None = None,
 ) -> BudgetAllocation:
-    election, name_to_project = _translate_input_format(instance, profile)
-    result = _core.mes_apr(election, tie_breaking)
-    return BudgetAllocation(name_to_project[project_embeding.name] for project_embeding in result)
+    prepared = _prepare(instance, profile, allow_cardinal=completion is None and not exact)
+    _check_log(log, completion, exact)
+    if exact:
+        _check_exact_completion(completion)
+        return prepared._allocation(_core.mes_apr_exact_indices, tie_breaking)
+    match completion:
+        case None:
+            return prepared._allocation(_core.mes_apr_indices, tie_breaking, num_threads, log=log)
+        case Completion.ADD1:
+            return prepared._allocation(_core.mes_apr_add1_indices, tie_breaking)
+        case Completion.ADD1U:
+            return prepared._allocation(_core.mes_apr_add1u_indices, tie_breaking)
+
+
+def mes_apr_sweep(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    budgets: list[int],
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[BudgetAllocation]:
+    prepared = _prepare(instance, profile)
+    allocations = _core.mes_apr_sweep(prepared.election, _translate_budgets(budgets), tie_breaking)
+    return _translate_allocations(allocations, prepared.projects)
 
 
 def mes_apr_measure(
-    instance: Instance,
-    profile: Profile,
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
     project: Project,
     measure: Measure,
     tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
 ) -> int | None:
-    election, _ = _translate_input_format(instance, profile)
-    p = sorted(instance).index(project)
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
     match measure:
         case Measure.COST_REDUCTION:
-            return _core.cost_reduction_for_mes_apr(election, p, tie_breaking)
+            return prepared._measure(_core.cost_reduction_for_mes_apr, project, tie_breaking)
         case Measure.ADD_APPROVAL_OPTIMIST:
-            return _core.optimist_add_for_mes_apr(election, p, tie_breaking)
+            return prepared._measure(_core.optimist_add_for_mes_apr, project, tie_breaking)
         case Measure.ADD_APPROVAL_PESSIMIST:
-            return _core.pessimist_add_for_mes_apr(election, p, tie_breaking)
+            return prepared._measure(_core.pessimist_add_for_mes_apr, project, tie_breaking)
         case Measure.ADD_SINGLETON:
-            return _core.singleton_add_for_mes_apr(election, p, tie_breaking)
+            return prepared._measure(_core.singleton_add_for_mes_apr, project, tie_breaking)
+
+
+def mes_apr_measure_values(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    measure: Measure,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> npt.NDArray[np.int64]:
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
+    match measure:
+        case Measure.COST_REDUCTION:
+            return prepared._measure_values(_core.cost_reduction_for_mes_apr_values, tie_breaking)
+        case Measure.ADD_APPROVAL_OPTIMIST:
+            return prepared._measure_values(_core.optimist_add_for_mes_apr_values, tie_breaking)
+        case Measure.ADD_APPROVAL_PESSIMIST:
+            return prepared._measure_values(_core.pessimist_add_for_mes_apr_values, tie_breaking)
+        case Measure.ADD_SINGLETON:
+            return prepared._measure_values(_core.singleton_add_for_mes_apr_values, tie_breaking)
+
+
+def mes_apr_sensitivity_curve(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    project: Project,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[SensitivityPoint]:
+    prepared = _prepare(instance, profile)
+    curve = _core.sensitivity_curve_for_mes_apr(prepared.election, prepared.index(project), tie_breaking)
+    return _translate_curve(curve, prepared.projects)
 
 
 def mes_cost(
-    instance: Instance, profile: Profile, tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc
+    instance: Instance | PreparedElection,
+    profile: Profile | None = None,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+    completion: Completion | None = None,
+    num_threads: int = 1,
+    exact: bool = False,
+    log: RoundLog | None = None,
 ) -> BudgetAllocation:
-    election, name_to_project = _translate_input_format(instance, profile)
-    result = _core.mes_cost(election, tie_breaking)
-    return BudgetAllocation(name_to_project[project_embeding.name] for project_embeding in result)
+    prepared = _prepare(instance, profile, allow_cardinal=completion is None and not exact)
+    _check_log(log, completion, exact)
+    if exact:
+        _check_exact_completion(completion)
+        return prepared._allocation(_core.mes_cost_exact_indices, tie_breaking)
+    match completion:
+        case None:
+            return prepared._allocation(_core.mes_cost_indices, tie_breaking, num_threads, log=log)
+        case Completion.ADD1:
+            return prepared._allocation(_core.mes_cost_add1_indices, tie_breaking)
+        case Completion.ADD1U:
+            return prepared._allocation(_core.mes_cost_add1u_indices, tie_breaking)
+
+
+def mes_cost_sweep(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    budgets: list[int],
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[BudgetAllocation]:
+    prepared = _prepare(instance, profile)
+    allocations = _core.mes_cost_sweep(prepared.election, _translate_budgets(budgets), tie_breaking)
+    return _translate_allocations(allocations, prepared.projects)
 
 
 def mes_cost_measure(
-    instance: Instance,
-    profile: Profile,
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    project: Project,
+    measure: Measure,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> int | None:
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
+    match measure:
+        case Measure.COST_REDUCTION:
+            return prepared._measure(_core.cost_reduction_for_mes_cost, project, tie_breaking)
+        case Measure.ADD_APPROVAL_OPTIMIST:
+            return prepared._measure(_core.optimist_add_for_mes_cost, project, tie_breaking)
+        case Measure.ADD_APPROVAL_PESSIMIST:
+            return prepared._measure(_core.pessimist_add_for_mes_cost, project, tie_breaking)
+        case Measure.ADD_SINGLETON:
+            return prepared._measure(_core.singleton_add_for_mes_cost, project, tie_breaking)
+
+
+def mes_cost_measure_values(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    measure: Measure,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> npt.NDArray[np.int64]:
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
+    match measure:
+        case Measure.COST_REDUCTION:
+            return prepared._measure_values(_core.cost_reduction_for_mes_cost_values, tie_breaking)
+        case Measure.ADD_APPROVAL_OPTIMIST:
+            return prepared._measure_values(_core.optimist_add_for_mes_cost_values, tie_breaking)
+        case Measure.ADD_APPROVAL_PESSIMIST:
+            return prepared._measure_values(_core.pessimist_add_for_mes_cost_values, tie_breaking)
+        case Measure.ADD_SINGLETON:
+            return prepared._measure_values(_core.singleton_add_for_mes_cost_values, tie_breaking)
+
+
+def mes_cost_sensitivity_curve(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    project: Project,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[SensitivityPoint]:
+    prepared = _prepare(instance, profile)
+    curve = _core.sensitivity_curve_for_mes_cost(prepared.election, prepared.index(project), tie_breaking)
+    return _translate_curve(curve, prepared.projects)
+
+
+def mes_sqrt_cost(
+    instance: Instance | PreparedElection,
+    profile: Profile | None = None,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+    num_threads: int = 1,
+    log: RoundLog | None = None,
+) -> BudgetAllocation:
+    prepared = _prepare(instance, profile, allow_cardinal=True)
+    return prepared._allocation(_core.mes_sqrt_cost_indices, tie_breaking, num_threads, log=log)
+
+
+def mes_sqrt_cost_sweep(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    budgets: list[int],
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[BudgetAllocation]:
+    prepared = _prepare(instance, profile)
+    allocations = _core.mes_sqrt_cost_sweep(prepared.election, _translate_budgets(budgets), tie_breaking)
+    return _translate_allocations(allocations, prepared.projects)
+
+
+def mes_sqrt_cost_measure(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
     project: Project,
     measure: Measure,
     tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
 ) -> int | None:
-    election, _ = _translate_input_format(instance, profile)
-    p = sorted(instance).index(project)
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
     match measure:
         case Measure.COST_REDUCTION:
-            return _core.cost_reduction_for_mes_cost(election, p, tie_breaking)
+            return prepared._measure(_core.cost_reduction_for_mes_sqrt_cost, project, tie_breaking)
         case Measure.ADD_APPROVAL_OPTIMIST:
-            return _core.optimist_add_for_mes_cost(election, p, tie_breaking)
+            return prepared._measure(_core.optimist_add_for_mes_sqrt_cost, project, tie_breaking)
         case Measure.ADD_APPROVAL_PESSIMIST:
-            return _core.pessimist_add_for_mes_cost(election, p, tie_breaking)
+            return prepared._measure(_core.pessimist_add_for_mes_sqrt_cost, project, tie_breaking)
         case Measure.ADD_SINGLETON:
-            return _core.singleton_add_for_mes_cost(election, p, tie_breaking)
+            return prepared._measure(_core.singleton_add_for_mes_sqrt_cost, project, tie_breaking)
+
+
+def mes_sqrt_cost_measure_values(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    measure: Measure,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> npt.NDArray[np.int64]:
+    prepared = _prepare(instance, profile, allow_cardinal=measure == Measure.COST_REDUCTION)
+    match measure:
+        case Measure.COST_REDUCTION:
+            return prepared._measure_values(_core.cost_reduction_for_mes_sqrt_cost_values, tie_breaking)
+        case Measure.ADD_APPROVAL_OPTIMIST:
+            return prepared._measure_values(_core.optimist_add_for_mes_sqrt_cost_values, tie_breaking)
+        case Measure.ADD_APPROVAL_PESSIMIST:
+            return prepared._measure_values(_core.pessimist_add_for_mes_sqrt_cost_values, tie_breaking)
+        case Measure.ADD_SINGLETON:
+            return prepared._measure_values(_core.singleton_add_for_mes_sqrt_cost_values, tie_breaking)
+
+
+def mes_sqrt_cost_sensitivity_curve(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    project: Project,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[SensitivityPoint]:
+    prepared = _prepare(instance, profile)
+    curve = _core.sensitivity_curve_for_mes_sqrt_cost(prepared.election, prepared.index(project), tie_breaking)
+    return _translate_curve(curve, prepared.projects)
 
 
 def phragmen(
-    instance: Instance, profile: Profile, tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc
+    instance: Instance | PreparedElection,
+    profile: Profile | None = None,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+    num_threads: int = 1,
+    exact: bool = False,
+    log: RoundLog | None = None,
 ) -> BudgetAllocation:
-    election, name_to_project = _translate_input_format(instance, profile)
-    result = _core.phragmen(election, tie_breaking)
-    return BudgetAllocation(name_to_project[project_embeding.name] for project_embeding in result)
+    prepared = _prepare(instance, profile)
+    _check_log(log, None, exact)
+    if exact:
+        return prepared._allocation(_core.phragmen_exact_indices, tie_breaking)
+    return prepared._allocation(_core.phragmen_indices, tie_breaking, num_threads, log=log)
+
+
+def phragmen_sweep(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    budgets: list[int],
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[BudgetAllocation]:
+    prepared = _prepare(instance, profile)
+    allocations = _core.phragmen_sweep(prepared.election, _translate_budgets(budgets), tie_breaking)
+    return _translate_allocations(allocations, prepared.projects)
 
 
 def phragmen_measure(
-    instance: Instance,
-    profile: Profile,
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
     project: Project,
     measure: Measure,
     tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
 ) -> int | None:
-    election, _ = _translate_input_format(instance, profile)
-    p = sorted(instance).index(project)
+    prepared = _prepare(instance, profile)
+    match measure:
+        case Measure.COST_REDUCTION:
+            return prepared._measure(_core.cost_reduction_for_phragmen, project, tie_breaking)
+        case Measure.ADD_APPROVAL_OPTIMIST:
+            return prepared._measure(_core.optimist_add_for_phragmen, project, tie_breaking)
+        case Measure.ADD_APPROVAL_PESSIMIST:
+            return prepared._measure(_core.pessimist_add_for_phragmen, project, tie_breaking)
+        case Measure.ADD_SINGLETON:
+            return prepared._measure(_core.singleton_add_for_phragmen, project, tie_breaking)
+
+
+def phragmen_measure_values(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    measure: Measure,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> npt.NDArray[np.int64]:
+    prepared = _prepare(instance, profile)
     match measure:
         case Measure.COST_REDUCTION:
-            return _core.cost_reduction_for_phragmen(election, p, tie_breaking)
+            return prepared._measure_values(_core.cost_reduction_for_phragmen_values, tie_breaking)
         case Measure.ADD_APPROVAL_OPTIMIST:
-            return _core.optimist_add_for_phragmen(election, p, tie_breaking)
+            return prepared._measure_values(_core.optimist_add_for_phragmen_values, tie_breaking)
         case Measure.ADD_APPROVAL_PESSIMIST:
-            return _core.pessimist_add_for_phragmen(election, p, tie_breaking)
+            return prepared._measure_values(_core.pessimist_add_for_phragmen_values, tie_breaking)
         case Measure.ADD_SINGLETON:
-            return _core.singleton_add_for_phragmen(election, p, tie_breaking)
+            return prepared._measure_values(_core.singleton_add_for_phragmen_values, tie_breaking)
+
+
+def phragmen_sensitivity_curve(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    project: Project,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+) -> list[SensitivityPoint]:
+    prepared = _prepare(instance, profile)
+    curve = _core.sensitivity_curve_for_phragmen(prepared.election, prepared.index(project), tie_breaking)
+    return _translate_curve(curve, prepared.projects)
+
+
+def selection_frequencies(
+    instance: Instance | PreparedElection,
+    profile: Profile | None,
+    rule: Callable[..., BudgetAllocation],
+    num_samples: int,
+    drop_fraction: float | None = None,
+    seed: int = 0,
+    tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+    num_threads: int = 1,
+) -> npt.NDArray[np.float64]:
+    rules = {
+        greedy: _core.SampledRule.GREEDY,
+        greedy_over_cost: _core.SampledRule.GREEDY_OVER_COST,
+        mes_apr: _core.SampledRule.MES_APR,
+        mes_cost: _core.SampledRule.MES_COST,
+        phragmen: _core.SampledRule.PHRAGMEN,
+    }
+    if rule not in rules:
+        raise ValueError("Rule must be greedy, greedy_over_cost, mes_apr, mes_cost or phragmen")
+    if num_samples <= 0:
+        raise ValueError("Number of samples must be positive")
+    if drop_fraction is not None and not 0 <= drop_fraction < 1:
+        raise ValueError("Drop fraction must be at least 0 and less than 1")
+    if not 0 <= seed < 2**64:
+        raise ValueError("Seed must be a non-negative 64-bit integer")
+    election = _prepare(instance, profile).election
+    if drop_fraction is None:
+        resampling, drop_fraction = _core.Resampling.BOOTSTRAP, 0.0
+    else:
+        resampling = _core.Resampling.DROP
+    return _core.selection_frequencies(
+        election, rules[rule], resampling, drop_fraction, num_samples, seed, tie_breaking, num_threads
+    )
+
+
+# MES or Phragmén outcome kept up to date while ballots are added and retracted (late postal votes, invalidations).
+# Every round is checkpointed, and after edits the rule resumes from the first round whose decision the edited ballots
+# could change. For MES, edits changing the number of voters change every voter budget and rerun the whole rule.
+# Outcome of mes_apr, mes_cost or phragmen kept up to date while ballots are added and retracted. For MES, the voter
+# budget depends on the number of voters, so an allocation() after edits that change it (an added or retracted ballot
+# not balanced by another) re-runs the rule from round 0.
+class Recount:
+    def __init__(
+        self,
+        instance: Instance,
+        profile: Profile,
+        rule: Callable[..., BudgetAllocation],
+        tie_breaking: ProjectComparator = ProjectComparator.ByCostAsc,
+    ):
+        rules = {
+            mes_apr: _core.RecountRule.MES_APR,
+            mes_cost: _core.RecountRule.MES_COST,
+            phragmen: _core.RecountRule.PHRAGMEN,
+        }
+        if rule not in rules:
+            raise ValueError("Rule must be mes_apr, mes_cost or phragmen")
+        prepared = PreparedElection(instance, profile)
+        if prepared.cardinal:
+            raise TypeError("Profile must be of type ApprovalProfile")
+        election, self._projects = prepared.election, prepared.projects
+        self._index = {project.name: i for i, project in enumerate(self._projects)}
+        voter_classes = _voter_classes(profile)
+        self._voter_classes = {approved_names: i for i, approved_names in enumerate(voter_classes)}
+        self._voter_weights = list(voter_classes.values())
+        self._num_of_voters = len(profile)
+        self._recount = _core.Recount(election, rules[rule], tie_breaking)
+
+    def _approved_names(self, ballot: Iterable[Project]) -> frozenset[str]:
+        approved_names = frozenset(project.name for project in ballot)
+        if any(name not in self._index for name in approved_names):
+            raise ValueError("Ballot must only approve projects of the instance")
+        return approved_names
+
+    def _change_weight(self, voter_class: int, change: int) -> None:
+        self._voter_weights[voter_class] += change
+        self._num_of_voters += change
+        self._recount.set_weight(voter_class, self._voter_weights[voter_class])
+
+    def add_ballot(self, ballot: Iterable[Project]) -> None:
+        approved_names = self._approved_names(ballot)
+        if approved_names not in self._voter_classes:
+            approved = [self._index[name] for name in approved_names]
+            self._voter_classes[approved_names] = self._recount.add_voter_class(approved, 0)
+            self._voter_weights.append(0)
+        self._change_weight(self._voter_classes[approved_names], 1)
+
+    def retract_ballot(self, ballot: Iterable[Project]) -> None:
+        voter_class = self._voter_classes.get(self._approved_names(ballot))
+        if voter_class is None or self._voter_weights[voter_class] == 0:
+            raise ValueError("Ballot must have been added before it is retracted")
+        self._change_weight(voter_class, -1)
+
+    def allocation(self) -> BudgetAllocation:
+        if self._num_of_voters == 0:
+            raise ValueError("Profile must contain at least one ballot")
+        return BudgetAllocation(self._projects[i] for i in self._recount.winners())
+
+    # round from which the last allocation() had to rerun the rule (the number of rounds if none)
+    @property
+    def resumed_round(self) -> int:
+        return self._recount.resumed_round
+
+
+# Binary election files: the translated election, with its voter classes merged, in a layout that load_election maps
+# into memory instead of parsing. Loading shares the approvers and utilities with the page cache of the file, so many
+# processes opening the same file hold one copy of them. Projects are in the order of sorted(instance).
+def save_election(instance: Instance, profile: Profile, path: str | PathLike[str]) -> None:
+    election = _prepare(instance, profile, allow_cardinal=True).election
+    if not _core.save_election(election, fspath(path)):
+        raise OSError(f"Could not write the election file {fspath(path)}")
+
+
+def convert_pabulib(pabulib_path: str | PathLike[str], path: str | PathLike[str]) -> None:
+    instance, profile = parse_pabulib(fspath(pabulib_path))
+    save_election(instance, profile, path)
+
+
+def load_election(path: str | PathLike[str]) -> _core.Election:
+    election = _core.load_election(fspath(path))
+    if election is None:
+        with open(path, "rb"):  # raises FileNotFoundError and the like if the file cannot be read
+            pass
+        raise ValueError(f"{fspath(path)} is not a valid election file")
+    return election
+
+
+# Elections in POSIX shared memory, for worker processes on one host: share_election writes the image of
+# save_election to a shared-memory object, and every worker attaches it by name instead of receiving and translating
+# its own copy, so the host holds the approvers once however many workers there are. The object outlives the
+# processes until unlink_shared_election, after which the attached elections stay valid. Not available on Windows.
+def _shared_memory_name(name: str) -> str:
+    name = name.removeprefix("/")
+    if not name or "/" in name:
+        raise ValueError("Shared-memory name must be non-empty and contain no slash after a leading one")
+    return "/" + name
+
+
+def share_election(instance: Instance | PreparedElection, profile: Profile | None, name: str) -> None:
+    election = _prepare(instance, profile, allow_cardinal=True).election
+    if not _core.share_election(election, _shared_memory_name(name)):
+        raise OSError(f"Could not create the shared-memory election {name}, which may exist already")
+
+
+def attach_election(name: str) -> _core.Election:
+    election = _core.attach_election(_shared_memory_name(name))
+    if election is None:
+        raise OSError(f"Could not attach the shared-memory election {name}, which may not exist")
+    return election
+
+
+def unlink_shared_election(name: str) -> None:
+    if not _core.unlink_shared_election(_shared_memory_name(name)):
+        raise FileNotFoundError(f"There is no shared-memory election {name}")
+
+
+# Futures of rules and measures computed on worker threads, for callers that must stay responsive while they run
+# (a web service, a notebook waiting on Ctrl-C). The C++ core runs without the GIL and polls the token of its future in
+# its loops and while the ILP solver runs, so cancelling a running future stops it within a round (or a few
+# milliseconds of SCIP) instead of when the measure would have returned.
+class MeasureFuture(Future):
+    def __init__(self) -> None:
+        super().__init__()
+        self._token = _core.CancellationToken()
+
+    # Unlike Future.cancel, also stops a running computation, after which the future is cancelled as well. Returns
+    # False only if the future had already finished.
+    def cancel(self) -> bool:
+        self._token.cancel()
+        return super().cancel() or not self.done()
+
+    # Moves the future from running to cancelled once its computation stopped: the steps of Future.cancel followed by
+    # those of set_running_or_notify_cancel for a cancelled future, so waiters, callbacks and cancelled() see it.
+    def _set_cancelled(self) -> None:
+        with self._condition:
+            self._state = CANCELLED_AND_NOTIFIED
+            for waiter in self._waiters:
+                waiter.add_cancelled(self)
+            self._condition.notify_all()
+        self._invoke_callbacks()
+
+    # Ctrl-C while waiting cancels the computation as well.
+    def result(self, timeout: float | None = None) -> Any:
+        try:
+            return super().result(timeout)
+        except KeyboardInterrupt:
+            self.cancel()
+            raise
+
+
+_executor: ThreadPoolExecutor | None = None
+_executor_lock = Lock()
+
+
+def _run(future: MeasureFuture, function: Callable[..., Any], args: tuple, kwargs: dict[str, Any]) -> None:
+    if not future.set_running_or_notify_cancel():
+        return
+    try:
+        with future._token:
+            result = function(*args, **kwargs)
+    except BaseException as error:
+        if not future._token.cancelled:
+            future.set_exception(error)
+            return
+    else:
+        if not future._token.cancelled:
+            future.set_result(result)
+            return
+    future._set_cancelled()  # whatever the stopped computation returned or raised is meaningless
+
+
+# Future of function(*args, **kwargs), where function is any rule, measure, curve or sweep of pabumeasures. Calls run
+# on a shared pool with a thread per CPU; pass a PreparedElection to share its translation and cache between them.
+def submit(function: Callable[..., Any], *args: Any, **kwargs: Any) -> MeasureFuture:
+    global _executor
+    with _executor_lock:
+        if _executor is None:
+            _executor = ThreadPoolExecutor(max_workers=cpu_count(), thread_name_prefix="pabumeasures")
+    future = MeasureFuture()
+    _executor.submit(_run, future, function, args, kwargs)
+    return future
+
+
+# Awaitable form of submit; cancelling the awaiting task cancels the computation.
+async def run_async(function: Callable[..., Any], *args: Any, **kwargs: Any) -> Any:
+    return await asyncio.wrap_future(submit(function, *args, **kwargs))
+
+
+# The futures in the order in which they finish. If the iteration stops early (break, an exception, Ctrl-C or the
+# timeout), the futures not yet yielded are cancelled.
+def as_completed(futures: Iterable[MeasureFuture], timeout: float | None = None) -> Iterator[MeasureFuture]:
+    futures = list(futures)
+    try:
+        yield from _as_completed(futures, timeout)
+    except BaseException:
+        for future in futures:
+            future.cancel()
+        raise
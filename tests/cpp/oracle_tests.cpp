@@ -0,0 +1,346 @@
+// Checks every measure of every rule against brute force on seeded random elections, like tests/test_measures.py but
+// fast enough for larger instances and millions of cases. Cases are spread over threads and the first failure stops
+// all of them; it is reported with its seed, so it can be rerun alone with --cases=1 --seed=<seed>. With
+// --max-utility above 1, voters have cardinal ballots with utilities in [1, max-utility] and only the rules that
+// support them, and their cost reduction, are checked.
+//
+// usage: oracle_tests [--cases=N] [--projects=M] [--voters=N] [--max-cost=C] [--max-utility=U] [--seed=S]
+//                     [--threads=T]
+
+#include "pb_rules_and_measures/Greedy.h"
+#include "pb_rules_and_measures/GreedyOverCost.h"
+#include "pb_rules_and_measures/MesApr.h"
+#include "pb_rules_and_measures/MesCost.h"
+#include "pb_rules_and_measures/MesSqrtCost.h"
+#include "pb_rules_and_measures/Phragmen.h"
+#include "utils/Election.h"
+#include "utils/ProjectComparator.h"
+#include "utils/ProjectEmbedding.h"
+#include "utils/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+struct Options {
+    long long cases = 100000;
+    int projects = 8;
+    int voters = 12;
+    long long max_cost = 10;
+    long long max_utility = 1;
+    unsigned long long seed = 0;
+    int threads = 0;
+};
+
+using Rule = std::function<std::vector<ProjectEmbedding>(const Election &, const ProjectComparator &)>;
+using CostMeasure = long long (*)(const Election &, int, const ProjectComparator &);
+using AddMeasure = std::optional<int> (*)(const Election &, int, const ProjectComparator &);
+
+struct RuleUnderTest {
+    const char *name;
+    Rule rule;
+    CostMeasure cost_reduction;
+    AddMeasure optimist_add, pessimist_add, singleton_add;
+    bool is_mes;
+    bool supports_cardinal;
+};
+
+const std::vector<RuleUnderTest> &rules_under_test() {
+    static const std::vector<RuleUnderTest> rules = {
+        {"greedy", greedy, cost_reduction_for_greedy, optimist_add_for_greedy, pessimist_add_for_greedy,
+         singleton_add_for_greedy, false, true},
+        {"greedy_over_cost", greedy_over_cost, cost_reduction_for_greedy_over_cost, optimist_add_for_greedy_over_cost,
+         pessimist_add_for_greedy_over_cost, singleton_add_for_greedy_over_cost, false, true},
+        {"mes_apr", [](const Election &election, const ProjectComparator &tie) { return mes_apr(election, tie); },
+         cost_reduction_for_mes_apr, optimist_add_for_mes_apr, pessimist_add_for_mes_apr, singleton_add_for_mes_apr,
+         true, true},
+        {"mes_cost", [](const Election &election, const ProjectComparator &tie) { return mes_cost(election, tie); },
+         cost_reduction_for_mes_cost, optimist_add_for_mes_cost, pessimist_add_for_mes_cost,
+         singleton_add_for_mes_cost, true, true},
+        {"mes_sqrt_cost",
+         [](const Election &election, const ProjectComparator &tie) { return mes_sqrt_cost(election, tie); },
+         cost_reduction_for_mes_sqrt_cost, optimist_add_for_mes_sqrt_cost, pessimist_add_for_mes_sqrt_cost,
+         singleton_add_for_mes_sqrt_cost, true, true},
+        {"phragmen", [](const Election &election, const ProjectComparator &tie) { return phragmen(election, tie); },
+         cost_reduction_for_phragmen, optimist_add_for_phragmen, pessimist_add_for_phragmen,
+         singleton_add_for_phragmen, false, false},
+    };
+    return rules;
+}
+
+// Same distribution as tests/utils.py: the given numbers of projects and voters, costs in [1, max_cost], a feasible
+// budget and every voter approving every project with probability 1/2.
+struct Case {
+    long long budget;
+    int num_of_voters;
+    std::vector<long long> costs;
+    std::vector<std::vector<int>> approvers;
+    std::vector<std::vector<long long>> utilities; // parallel to approvers for cardinal ballots, empty otherwise
+    int p;
+
+    Election election() const { return with(p, costs[p], approvers[p], num_of_voters); }
+
+    // The election with project p changed (with cardinal ballots, only its cost can change).
+    Election with(int p, long long cost, const std::vector<int> &p_approvers, int n_voters) const {
+        std::vector<ProjectEmbedding> projects;
+        for (int i = 0; i < static_cast<int>(costs.size()); i++) {
+            if (!utilities.empty()) {
+                projects.emplace_back(i == p ? cost : costs[i], "p" + std::to_string(i), approvers[i], utilities[i]);
+                continue;
+            }
+            projects.emplace_back(i == p ? cost : costs[i], "p" + std::to_string(i),
+                                  i == p ? p_approvers : approvers[i]);
+        }
+        return Election(budget, n_voters, std::move(projects));
+    }
+};
+
+Case random_case(const Options &options, std::mt19937_64 &rng) {
+    Case c;
+    auto uniform = [&rng](long long low, long long high) {
+        return std::uniform_int_distribution<long long>(low, high)(rng);
+    };
+    int m = options.projects;
+    c.num_of_voters = options.voters;
+    c.approvers.resize(m);
+    if (options.max_utility > 1) {
+        c.utilities.resize(m);
+    }
+    for (int i = 0; i < m; i++) {
+        c.costs.push_back(uniform(1, options.max_cost));
+        for (int v = 0; v < c.num_of_voters; v++) {
+            if (uniform(0, 1)) {
+                c.approvers[i].push_back(v);
+                if (options.max_utility > 1) {
+                    c.utilities[i].push_back(uniform(1, options.max_utility));
+                }
+            }
+        }
+    }
+    long long sum = 0;
+    for (auto cost : c.costs) {
+        sum += cost;
+    }
+    c.budget = uniform(*std::ranges::max_element(c.costs), sum);
+    c.p = uniform(0, m - 1);
+    return c;
+}
+
+bool selected(const RuleUnderTest &rule, const Election &election, int p, const ProjectComparator &tie_breaking) {
+    auto name = "p" + std::to_string(p);
+    return std::ranges::any_of(rule.rule(election, tie_breaking),
+                               [&name](const ProjectEmbedding &winner) { return winner.name() == name; });
+}
+
+// Whether p is selected after the non-approvers in the bitmask (over non_approvers) approve it too.
+bool selected_with(const RuleUnderTest &rule, const Case &c, const std::vector<int> &non_approvers, std::uint32_t mask,
+                   const ProjectComparator &tie_breaking) {
+    auto p_approvers = c.approvers[c.p];
+    for (int i = 0; i < static_cast<int>(non_approvers.size()); i++) {
+        if (mask >> i & 1) {
+            p_approvers.push_back(non_approvers[i]);
+        }
+    }
+    std::ranges::sort(p_approvers);
+    return selected(rule, c.with(c.p, c.costs[c.p], p_approvers, c.num_of_voters), c.p, tie_breaking);
+}
+
+// Calls f on every mask of size k over n bits (Gosper's hack) until it returns false; returns whether all passed.
+template <typename F> bool all_subsets_of_size(int n, int k, F &&f) {
+    if (k == 0) {
+        return f(std::uint32_t{0});
+    }
+    for (std::uint32_t mask = (1u << k) - 1; mask < (1u << n);) {
+        if (!f(mask)) {
+            return false;
+        }
+        std::uint32_t lowest = mask & -mask, ripple = mask + lowest;
+        mask = ((ripple ^ mask) >> 2) / lowest | ripple;
+    }
+    return true;
+}
+
+std::string describe(const std::optional<long long> &value) { return value ? std::to_string(*value) : "None"; }
+
+// Returns a description of the first measure that disagrees with brute force, if any.
+std::optional<std::string> check(const RuleUnderTest &rule, const Case &c, const ProjectComparator &tie_breaking) {
+    auto election = c.election();
+    int p = c.p;
+    bool in_allocation = selected(rule, election, p, tie_breaking);
+    std::vector<int> non_approvers;
+    for (int v = 0, i = 0; v < c.num_of_voters; v++) {
+        if (i < static_cast<int>(c.approvers[p].size()) && c.approvers[p][i] == v) {
+            i++;
+        } else {
+            non_approvers.push_back(v);
+        }
+    }
+    int n = non_approvers.size();
+    auto fail = [&rule](const char *measure, std::optional<long long> expected, std::optional<long long> result) {
+        return std::string(rule.name) + " " + measure + ": expected " + describe(expected) + ", got " +
+               describe(result);
+    };
+
+    // cost reduction: p is selected at the returned cost (if positive) and not at one more
+    long long price = rule.cost_reduction(election, p, tie_breaking);
+    if (in_allocation) {
+        if (price != c.costs[p]) {
+            return fail("cost_reduction", c.costs[p], price);
+        }
+    } else if (price < 0 || (price > 0 && !selected(rule, c.with(p, price, c.approvers[p], c.num_of_voters), p,
+                                                     tie_breaking)) ||
+               selected(rule, c.with(p, price + 1, c.approvers[p], c.num_of_voters), p, tie_breaking)) {
+        return fail("cost_reduction", {}, price);
+    }
+    if (!c.utilities.empty()) {
+        return {}; // the other measures add approvers, so they are only defined for approval ballots
+    }
+
+    // optimist: the fewest new approvers for which some choice of them gets p selected
+    std::optional<long long> expected;
+    if (in_allocation) {
+        expected = 0;
+    } else {
+        for (int k = 1; k <= n && !expected; k++) {
+            bool none_selects = all_subsets_of_size(
+                n, k, [&](std::uint32_t mask) { return !selected_with(rule, c, non_approvers, mask, tie_breaking); });
+            if (!none_selects) {
+                expected = k;
+            }
+        }
+    }
+    auto optimist = rule.optimist_add(election, p, tie_breaking);
+    if (optimist != expected) {
+        return fail("optimist_add", expected, optimist);
+    }
+
+    // pessimist: the fewest new approvers for which every choice of them gets p selected
+    expected.reset();
+    if (in_allocation) {
+        expected = 0;
+    } else {
+        for (int k = 1; k <= n && !expected; k++) {
+            if (all_subsets_of_size(n, k, [&](std::uint32_t mask) {
+                    return selected_with(rule, c, non_approvers, mask, tie_breaking);
+                })) {
+                expected = k;
+            }
+        }
+    }
+    auto pessimist = rule.pessimist_add(election, p, tie_breaking);
+    if (pessimist != expected) {
+        return fail("pessimist_add", expected, pessimist);
+    }
+
+    // singleton: p is selected with the returned number of new voters approving only p, and not with one less
+    auto singleton = rule.singleton_add(election, p, tie_breaking);
+    auto selected_with_singletons = [&](int k) {
+        auto p_approvers = c.approvers[p];
+        for (int v = 0; v < k; v++) {
+            p_approvers.push_back(c.num_of_voters + v);
+        }
+        return selected(rule, c.with(p, c.costs[p], p_approvers, c.num_of_voters + k), p, tie_breaking);
+    };
+    if (!singleton) {
+        if (!rule.is_mes || c.budget != c.costs[p]) {
+            return fail("singleton_add", {}, singleton);
+        }
+    } else if (in_allocation ? *singleton != 0
+                             : *singleton < 1 || !selected_with_singletons(*singleton) ||
+                                   selected_with_singletons(*singleton - 1)) {
+        return fail("singleton_add", {}, singleton);
+    }
+    return {};
+}
+
+std::optional<Options> parse(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        auto separator = argument.find('=');
+        if (argument.rfind("--", 0) != 0 || separator == std::string::npos) {
+            return {};
+        }
+        auto key = argument.substr(2, separator - 2);
+        auto value = std::stoll(argument.substr(separator + 1));
+        if (key == "cases") {
+            options.cases = value;
+        } else if (key == "projects") {
+            options.projects = value;
+        } else if (key == "voters") {
+            options.voters = value;
+        } else if (key == "max-cost") {
+            options.max_cost = value;
+        } else if (key == "max-utility") {
+            options.max_utility = value;
+        } else if (key == "seed") {
+            options.seed = value;
+        } else if (key == "threads") {
+            options.threads = value;
+        } else {
+            return {};
+        }
+    }
+    if (options.voters > 24) {
+        return {}; // brute force over subsets of the voters
+    }
+    return options;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    auto options = parse(argc, argv);
+    if (!options) {
+        std::fprintf(stderr, "usage: oracle_tests [--cases=N] [--projects=M] [--voters=N (at most 24)] "
+                             "[--max-cost=C] [--max-utility=U] [--seed=S] [--threads=T]\n");
+        return 2;
+    }
+    // The measures keep the tie-breaking order of the original election, so only comparators under which lowering the
+    // cost of p or adding approvers to it cannot move it back in the order are used.
+    const ProjectComparator *tie_breakings[] = {&ProjectComparator::ByCostAsc, &ProjectComparator::ByNameAsc,
+                                                &ProjectComparator::ByNameDesc};
+
+    ThreadPool pool(options->threads);
+    std::atomic<long long> next_case = 0, checked = 0;
+    std::atomic<bool> failed = false;
+    std::mutex report_mutex;
+    pool.parallel_for(pool.size(), [&](int begin, int end) {
+        for (int worker = begin; worker < end; worker++) {
+            for (long long i = next_case++; i < options->cases && !failed; i = next_case++) {
+                auto seed = options->seed + i;
+                std::seed_seq seed_sequence{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+                std::mt19937_64 rng(seed_sequence);
+                auto c = random_case(*options, rng);
+                const auto &tie_breaking = *tie_breakings[seed % std::size(tie_breakings)];
+                for (const auto &rule : rules_under_test()) {
+                    if (!c.utilities.empty() && !rule.supports_cardinal) {
+                        continue;
+                    }
+                    if (auto failure = check(rule, c, tie_breaking)) {
+                        std::lock_guard lock(report_mutex);
+                        if (!failed.exchange(true)) {
+                            std::fprintf(stderr, "seed %llu (p = %d): %s\n", seed, c.p, failure->c_str());
+                        }
+                        break;
+                    }
+                }
+                checked++;
+            }
+        }
+    });
+
+    if (failed) {
+        return 1;
+    }
+    std::printf("%lld cases passed\n", checked.load());
+    return 0;
+}
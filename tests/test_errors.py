@@ -1,5 +1,7 @@
+import struct
+
 import pytest
-from pabutools.election import ApprovalBallot, ApprovalProfile, Instance, Project
+from pabutools.election import ApprovalBallot, ApprovalProfile, CardinalBallot, CardinalProfile, Instance, Project
 
 import pabumeasures
 
@@ -91,3 +93,194 @@ def test_error_on_huge_budget():
 
     with pytest.raises(ValueError, match=r"[Bb]udget limit .+ exceed"):
         pabumeasures.greedy(instance, profile)
+
+
+def test_error_on_exact_completion():
+    p1 = Project("p1", 2)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = ApprovalProfile(
+        [
+            ApprovalBallot([p1]),
+            ApprovalBallot([p2]),
+        ]
+    )
+
+    with pytest.raises(ValueError, match=r"[Ee]xact .+ completion"):
+        pabumeasures.mes_apr(instance, profile, completion=pabumeasures.Completion.ADD1, exact=True)
+
+
+def test_error_on_round_log_with_completion():
+    p1 = Project("p1", 2)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = ApprovalProfile(
+        [
+            ApprovalBallot([p1]),
+            ApprovalBallot([p2]),
+        ]
+    )
+
+    with pytest.raises(ValueError, match=r"[Rr]ound logs .+ completions"):
+        pabumeasures.mes_cost(instance, profile, completion=pabumeasures.Completion.ADD1, log=pabumeasures.RoundLog())
+    with pytest.raises(ValueError, match=r"[Rr]ound logs .+ exact"):
+        pabumeasures.phragmen(instance, profile, exact=True, log=pabumeasures.RoundLog())
+
+
+def test_error_on_round_log_filled_concurrently():
+    p1 = Project("p1", 2)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = ApprovalProfile(
+        [
+            ApprovalBallot([p1]),
+            ApprovalBallot([p2]),
+        ]
+    )
+    log = pabumeasures.RoundLog()
+
+    with log._filling:  # as while another thread runs a rule with the log
+        with pytest.raises(ValueError, match=r"[Rr]ound log .+ being filled"):
+            pabumeasures.mes_cost(instance, profile, log=log)
+    pabumeasures.mes_cost(instance, profile, log=log)
+    assert len(log.winners) > 0
+
+
+def test_error_on_negative_utility():
+    p1 = Project("p1", 2)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = CardinalProfile(
+        [
+            CardinalBallot({p1: 2, p2: -1}),
+            CardinalBallot({p2: 3}),
+        ]
+    )
+
+    with pytest.raises(ValueError, match=r"utilities must be non-negative integers"):
+        pabumeasures.mes_apr(instance, profile)
+
+
+def test_error_on_profile_with_prepared_election():
+    p1 = Project("p1", 1)
+    instance = Instance([p1], 1)
+    profile = ApprovalProfile([ApprovalBallot([p1])])
+    prepared = pabumeasures.PreparedElection(instance, profile)
+
+    with pytest.raises(TypeError, match=r"[Pp]rofile must be left out"):
+        pabumeasures.greedy(prepared, profile)
+
+
+def test_error_on_huge_utility():
+    p1 = Project("p1", 2)
+    instance = Instance([p1], 2)
+    profile = CardinalProfile([CardinalBallot({p1: 2_000_000_000})])
+
+    with pytest.raises(ValueError, match=r"utilities must not exceed 1 billion"):
+        pabumeasures.mes_apr(instance, profile)
+
+
+def test_error_on_invalid_election_file(tmp_path):
+    path = tmp_path / "election.pbe"
+    path.write_bytes(b"PBELECT\0" + bytes(100))
+
+    with pytest.raises(ValueError, match=r"not a valid election file"):
+        pabumeasures.load_election(path)
+    with pytest.raises(FileNotFoundError):
+        pabumeasures.load_election(tmp_path / "missing.pbe")
+
+
+def test_error_on_election_file_without_voters_or_with_duplicate_names(tmp_path):
+    p1 = Project("p1", 1)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = ApprovalProfile([ApprovalBallot([p1]), ApprovalBallot([p1])])  # a single voter class of weight 2
+    path = tmp_path / "election.pbe"
+    pabumeasures.save_election(instance, profile, path)
+    image = path.read_bytes()
+
+    # the weights follow the header, the costs, the approver offsets and the approvers (padded to 8 bytes)
+    num_of_projects, num_of_voter_classes, num_of_approvals = struct.unpack_from("=3q", image, 32)
+    weights = 64 + 8 * num_of_projects + 8 * (num_of_projects + 1) + (4 * num_of_approvals + 7) // 8 * 8
+    assert num_of_voter_classes == 1 and struct.unpack_from("=i", image, weights) == (2,)
+    corrupted = [
+        image[:weights] + struct.pack("=i", 0) + image[weights + 4 :],
+        image.replace(b"p1p2", b"p1p1"),
+    ]
+    for i, image in enumerate(corrupted):
+        path = tmp_path / f"corrupted{i}.pbe"
+        path.write_bytes(image)
+        with pytest.raises(ValueError, match=r"not a valid election file"):
+            pabumeasures.load_election(path)
+
+
+def test_error_on_election_file_with_expensive_project_repeated_approver_or_invalid_name(tmp_path):
+    p1 = Project("p1", 1)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = ApprovalProfile([ApprovalBallot([p1]), ApprovalBallot([p1, p2])])  # p1 is approved by two voter classes
+    path = tmp_path / "election.pbe"
+    pabumeasures.save_election(instance, profile, path)
+    image = path.read_bytes()
+
+    # the costs follow the header, then the approver offsets and the approvers
+    num_of_projects, _, num_of_approvals = struct.unpack_from("=3q", image, 32)
+    offsets = struct.unpack_from(f"={num_of_projects + 1}q", image, 64 + 8 * num_of_projects)
+    approvers = 64 + 8 * num_of_projects + 8 * (num_of_projects + 1)
+    second = approvers + 4 * next(offsets[i] + 1 for i in range(num_of_projects) if offsets[i + 1] - offsets[i] == 2)
+    assert num_of_approvals == 3
+    corrupted = [
+        image[:64] + struct.pack("=q", 3) + image[72:],  # above the budget of 2
+        image[:second] + image[second - 4 : second] + image[second + 4 :],  # the first approver repeated
+        image.replace(b"p1p2", b"\xff1p2"),
+    ]
+    for i, image in enumerate(corrupted):
+        path = tmp_path / f"corrupted{i}.pbe"
+        path.write_bytes(image)
+        with pytest.raises(ValueError, match=r"not a valid election file"):
+            pabumeasures.load_election(path)
+
+
+def test_error_on_cardinal_completion_or_sweep_in_core():
+    p1 = Project("p1", 2)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = CardinalProfile([CardinalBallot({p1: 2}), CardinalBallot({p2: 3})])
+    election = pabumeasures.PreparedElection(instance, profile).election
+
+    # the budget incrementer behind them only supports approval ballots, also when called directly
+    with pytest.raises(TypeError, match=r"ApprovalProfile"):
+        pabumeasures._core.mes_apr_add1_indices(election, pabumeasures.ProjectComparator.ByCostAsc)
+    with pytest.raises(TypeError, match=r"ApprovalProfile"):
+        pabumeasures._core.mes_cost_add1u(election, pabumeasures.ProjectComparator.ByCostAsc)
+    with pytest.raises(TypeError, match=r"ApprovalProfile"):
+        pabumeasures._core.mes_sqrt_cost_sweep(election, [1, 2], pabumeasures.ProjectComparator.ByCostAsc)
+
+
+def test_error_on_shared_election_name():
+    p1 = Project("p1", 1)
+    instance = Instance([p1], 1)
+    profile = ApprovalProfile([ApprovalBallot([p1])])
+
+    with pytest.raises(ValueError, match=r"Shared-memory name"):
+        pabumeasures.share_election(instance, profile, "a/b")
+    with pytest.raises(ValueError, match=r"Shared-memory name"):
+        pabumeasures.attach_election("/")
+
+
+def test_error_on_cardinal_approval_measure():
+    p1 = Project("p1", 2)
+    p2 = Project("p2", 1)
+    instance = Instance([p1, p2], 2)
+    profile = CardinalProfile(
+        [
+            CardinalBallot({p1: 2}),
+            CardinalBallot({p2: 3}),
+        ]
+    )
+
+    assert pabumeasures.mes_apr_measure(instance, profile, p1, pabumeasures.Measure.COST_REDUCTION) == 1
+    with pytest.raises(TypeError, match=r"ApprovalProfile"):
+        pabumeasures.mes_apr_measure(instance, profile, p1, pabumeasures.Measure.ADD_APPROVAL_OPTIMIST)
+    with pytest.raises(TypeError, match=r"ApprovalProfile"):
+        pabumeasures.phragmen(instance, profile)
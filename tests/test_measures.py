@@ -1,12 +1,16 @@
+import asyncio
 import random
+import time
+from concurrent.futures import CancelledError
 from itertools import chain, combinations
+from threading import Event
 
 import pytest
 from pabutools.election import ApprovalBallot
-from utils import get_random_election, get_random_project
+from utils import get_random_cardinal_election, get_random_election, get_random_project
 
 import pabumeasures
-from pabumeasures import Measure
+from pabumeasures import Measure, ProjectComparator, _core
 
 
 def _powerset(iterable):
@@ -26,9 +30,10 @@ NUMBER_OF_TIMES = 500
         (pabumeasures.greedy_over_cost, pabumeasures.greedy_over_cost_measure),
         (pabumeasures.mes_apr, pabumeasures.mes_apr_measure),
         (pabumeasures.mes_cost, pabumeasures.mes_cost_measure),
+        (pabumeasures.mes_sqrt_cost, pabumeasures.mes_sqrt_cost_measure),
         (pabumeasures.phragmen, pabumeasures.phragmen_measure),
     ],
-    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "phragmen"],
+    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "mes_sqrt_cost", "phragmen"],
 )
 def test_optimist_add_measure(seed, rule, rule_measure):
     random.seed(seed)
@@ -65,9 +70,10 @@ def test_optimist_add_measure(seed, rule, rule_measure):
         (pabumeasures.greedy_over_cost, pabumeasures.greedy_over_cost_measure),
         (pabumeasures.mes_apr, pabumeasures.mes_apr_measure),
         (pabumeasures.mes_cost, pabumeasures.mes_cost_measure),
+        (pabumeasures.mes_sqrt_cost, pabumeasures.mes_sqrt_cost_measure),
         (pabumeasures.phragmen, pabumeasures.phragmen_measure),
     ],
-    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "phragmen"],
+    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "mes_sqrt_cost", "phragmen"],
 )
 def test_pessimist_add_measure(seed, rule, rule_measure):
     random.seed(seed)
@@ -102,9 +108,10 @@ def test_pessimist_add_measure(seed, rule, rule_measure):
         (pabumeasures.greedy_over_cost, pabumeasures.greedy_over_cost_measure),
         (pabumeasures.mes_apr, pabumeasures.mes_apr_measure),
         (pabumeasures.mes_cost, pabumeasures.mes_cost_measure),
+        (pabumeasures.mes_sqrt_cost, pabumeasures.mes_sqrt_cost_measure),
         (pabumeasures.phragmen, pabumeasures.phragmen_measure),
     ],
-    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "phragmen"],
+    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "mes_sqrt_cost", "phragmen"],
 )
 def test_singleton_add_measure(seed, rule, rule_measure):
     random.seed(seed)
@@ -113,7 +120,7 @@ def test_singleton_add_measure(seed, rule, rule_measure):
     allocation = rule(instance, profile)
     result = rule_measure(instance, profile, project, Measure.ADD_SINGLETON)
 
-    if rule in [pabumeasures.mes_apr, pabumeasures.mes_cost] and result is None:
+    if rule in [pabumeasures.mes_apr, pabumeasures.mes_cost, pabumeasures.mes_sqrt_cost] and result is None:
         assert instance.budget_limit == project.cost
     else:
         assert result is not None
@@ -137,9 +144,10 @@ def test_singleton_add_measure(seed, rule, rule_measure):
         (pabumeasures.greedy_over_cost, pabumeasures.greedy_over_cost_measure),
         (pabumeasures.mes_apr, pabumeasures.mes_apr_measure),
         (pabumeasures.mes_cost, pabumeasures.mes_cost_measure),
+        (pabumeasures.mes_sqrt_cost, pabumeasures.mes_sqrt_cost_measure),
         (pabumeasures.phragmen, pabumeasures.phragmen_measure),
     ],
-    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "phragmen"],
+    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "mes_sqrt_cost", "phragmen"],
 )
 def test_cost_reduction_measure(seed, rule, rule_measure):
     random.seed(seed)
@@ -159,3 +167,206 @@ def test_cost_reduction_measure(seed, rule, rule_measure):
 
         project.cost = result + 1
         assert project not in rule(instance, profile)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule,rule_measure",
+    [
+        (pabumeasures.greedy, pabumeasures.greedy_measure),
+        (pabumeasures.greedy_over_cost, pabumeasures.greedy_over_cost_measure),
+        (pabumeasures.mes_apr, pabumeasures.mes_apr_measure),
+        (pabumeasures.mes_cost, pabumeasures.mes_cost_measure),
+        (pabumeasures.mes_sqrt_cost, pabumeasures.mes_sqrt_cost_measure),
+    ],
+    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "mes_sqrt_cost"],
+)
+def test_cost_reduction_measure_cardinal(seed, rule, rule_measure):
+    random.seed(seed)
+    instance, profile = get_random_cardinal_election()
+    project = get_random_project(instance)
+    allocation = rule(instance, profile)
+    result = rule_measure(instance, profile, project, Measure.COST_REDUCTION)
+
+    if project in allocation:
+        assert result == project.cost
+    else:
+        if result > 0:
+            project.cost = result
+            assert project in rule(instance, profile)
+        else:
+            assert result == 0
+
+        project.cost = result + 1
+        assert project not in rule(instance, profile)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize("rule", ["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "mes_sqrt_cost", "phragmen"])
+def test_measures_on_voter_classes(seed, rule):
+    random.seed(seed)
+    instance, profile = get_random_election(num_agents=10)
+    election = pabumeasures.PreparedElection(instance, profile).election
+    assert election.num_of_voters == len(profile)
+    assert election.num_of_voter_classes <= len(profile)
+    expanded_election = _core.Election(
+        election.budget,
+        len(profile),
+        [
+            _core.ProjectEmbedding(
+                project.cost,
+                project.name,
+                [i for i, ballot in enumerate(profile) if project.name in {approved.name for approved in ballot}],
+            )
+            for project in election.projects
+        ],
+    )
+    tie_breaking = ProjectComparator.ByVotesDesc
+
+    rule_function = getattr(_core, rule)
+    assert [project.name for project in rule_function(election, tie_breaking)] == [
+        project.name for project in rule_function(expanded_election, tie_breaking)
+    ]
+    for measure in ["cost_reduction_for_", "optimist_add_for_", "pessimist_add_for_", "singleton_add_for_"]:
+        measure_function = getattr(_core, measure + rule)
+        for p in range(len(election.projects)):
+            assert measure_function(election, p, tie_breaking) == measure_function(expanded_election, p, tie_breaking)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES // 10)))
+@pytest.mark.parametrize(
+    "rule_measure,rule_measure_values",
+    [
+        (pabumeasures.greedy_measure, pabumeasures.greedy_measure_values),
+        (pabumeasures.greedy_over_cost_measure, pabumeasures.greedy_over_cost_measure_values),
+        (pabumeasures.mes_apr_measure, pabumeasures.mes_apr_measure_values),
+        (pabumeasures.mes_cost_measure, pabumeasures.mes_cost_measure_values),
+        (pabumeasures.mes_sqrt_cost_measure, pabumeasures.mes_sqrt_cost_measure_values),
+        (pabumeasures.phragmen_measure, pabumeasures.phragmen_measure_values),
+    ],
+)
+@pytest.mark.parametrize("measure", list(Measure))
+def test_measure_values(seed, rule_measure, rule_measure_values, measure):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    values = rule_measure_values(instance, profile, measure)
+    assert values.tolist() == [
+        -1 if (result := rule_measure(instance, profile, project, measure)) is None else result
+        for project in sorted(instance)
+    ]
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES // 10)))
+@pytest.mark.parametrize(
+    "rule_measure,rule_measure_values",
+    [
+        (pabumeasures.greedy_measure, pabumeasures.greedy_measure_values),
+        (pabumeasures.mes_cost_measure, pabumeasures.mes_cost_measure_values),
+        (pabumeasures.phragmen_measure, pabumeasures.phragmen_measure_values),
+    ],
+)
+@pytest.mark.parametrize("measure", list(Measure))
+def test_measures_on_prepared_election(seed, rule_measure, rule_measure_values, measure):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    expected = [rule_measure(instance, profile, project, measure) for project in sorted(instance)]
+    prepared = pabumeasures.PreparedElection(instance, profile)
+    assert [rule_measure(prepared, None, project, measure) for project in sorted(instance)] == expected
+    values = rule_measure_values(prepared, None, measure)
+    assert values.tolist() == [-1 if result is None else result for result in expected]
+    values[:] = 0  # the cached values are not shared
+    prepared = pabumeasures.PreparedElection(instance, profile)
+    rule_measure_values(prepared, None, measure)
+    assert [rule_measure(prepared, None, project, measure) for project in sorted(instance)] == expected
+
+
+def test_approvers_view_is_read_only():
+    project = _core.ProjectEmbedding(1, "p", [0, 2, 3])
+    assert project.approvers.tolist() == [0, 2, 3]
+    with pytest.raises(ValueError):
+        project.approvers[0] = 1
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES // 10)))
+@pytest.mark.parametrize(
+    "rule_measure,rule_sensitivity_curve",
+    [
+        (pabumeasures.mes_apr_measure, pabumeasures.mes_apr_sensitivity_curve),
+        (pabumeasures.mes_cost_measure, pabumeasures.mes_cost_sensitivity_curve),
+        (pabumeasures.mes_sqrt_cost_measure, pabumeasures.mes_sqrt_cost_sensitivity_curve),
+        (pabumeasures.phragmen_measure, pabumeasures.phragmen_sensitivity_curve),
+    ],
+)
+def test_sensitivity_curve(seed, rule_measure, rule_sensitivity_curve):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    project = get_random_project(instance)
+    curve = rule_sensitivity_curve(instance, profile, project)
+
+    assert curve
+    assert all(point.winner != project for point in curve[:-1])
+    assert max(point.price for point in curve) == rule_measure(instance, profile, project, Measure.COST_REDUCTION)
+    added_approvers = [point.added_approvers for point in curve if point.added_approvers is not None]
+    assert (min(added_approvers) if added_approvers else None) == rule_measure(
+        instance, profile, project, Measure.ADD_APPROVAL_OPTIMIST
+    )
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES // 10)))
+@pytest.mark.parametrize("measure", list(Measure))
+def test_submitted_measures(seed, measure):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    prepared = pabumeasures.PreparedElection(instance, profile)
+    futures = {
+        pabumeasures.submit(pabumeasures.mes_apr_measure, prepared, None, project, measure): project
+        for project in sorted(instance)
+    }
+    results = {futures[future]: future.result() for future in pabumeasures.as_completed(futures)}
+    assert results == {
+        project: pabumeasures.mes_apr_measure(instance, profile, project, measure) for project in instance
+    }
+    values = asyncio.run(pabumeasures.run_async(pabumeasures.phragmen_measure_values, instance, profile, measure))
+    assert values.tolist() == pabumeasures.phragmen_measure_values(instance, profile, measure).tolist()
+
+
+def test_cancelled_measure_values():
+    random.seed(0)
+    instance, profile = get_random_election(num_projects=10, num_agents=50)
+    election = pabumeasures.PreparedElection(instance, profile).election
+    token = _core.CancellationToken()
+    with token:
+        assert not _core.cancellation_requested()
+        token.cancel()
+        assert _core.cancellation_requested()
+        values = _core.pessimist_add_for_mes_apr_values(election, ProjectComparator.ByCostAsc)
+    assert not _core.cancellation_requested()
+    assert values.tolist() == [-1] * len(instance)  # stopped before the first project
+
+
+def test_cancelled_future():
+    random.seed(0)
+    instance, profile = get_random_election(num_projects=40, max_cost=100, num_agents=400)
+    prepared = pabumeasures.PreparedElection(instance, profile)
+    future = pabumeasures.submit(pabumeasures.mes_apr_measure_values, prepared, None, Measure.ADD_APPROVAL_PESSIMIST)
+    assert future.cancel()
+    with pytest.raises(CancelledError):
+        future.result()
+    assert not prepared._cache  # the meaningless values of the stopped computation are not remembered
+
+
+def test_cancelled_running_future():
+    random.seed(0)
+    instance, profile = get_random_election(num_projects=40, max_cost=100, num_agents=400)
+    prepared = pabumeasures.PreparedElection(instance, profile)
+    future = pabumeasures.submit(pabumeasures.mes_apr_measure_values, prepared, None, Measure.ADD_APPROVAL_PESSIMIST)
+    called_back = Event()
+    future.add_done_callback(lambda _: called_back.set())
+    while not future.running() and not future.done():
+        time.sleep(0.001)
+    assert future.cancel()
+    assert list(pabumeasures.as_completed([future])) == [future]
+    assert future.cancelled()
+    assert called_back.is_set()
+    with pytest.raises(CancelledError):
+        future.exception()
@@ -1,13 +1,35 @@
 import glob
+import multiprocessing
+import os
 import random
+import sys
+from collections import Counter
+from concurrent.futures import ProcessPoolExecutor
 
 import pytest
-from pabutools.election import ApprovalProfile, Cardinality_Sat, Cost_Sat, parse_pabulib
-from pabutools.rules import greedy_utilitarian_welfare, method_of_equal_shares, sequential_phragmen
+from pabutools.election import (
+    Additive_Cardinal_Sat,
+    ApprovalBallot,
+    ApprovalProfile,
+    CardinalBallot,
+    CardinalProfile,
+    Cardinality_Sat,
+    Cost_Sat,
+    Instance,
+    Project,
+    parse_pabulib,
+)
+from pabutools.rules import (
+    completion_by_rule_combination,
+    greedy_utilitarian_welfare,
+    method_of_equal_shares,
+    sequential_phragmen,
+)
 from pabutools.tiebreaking import TieBreakingRule
-from utils import get_random_election
+from utils import get_random_cardinal_election, get_random_election
 
 import pabumeasures
+from pabumeasures import Completion, Measure
 
 # redefined pabutools tie-breaking rules to include project name as a secondary criterion
 min_cost_tie_breaking = TieBreakingRule(lambda inst, prof, proj: (proj.cost, proj.name))
@@ -137,6 +159,101 @@ def test_mes_cost_random(seed):
     assert sorted(pabutools_result) == sorted(result)
 
 
+@pytest.mark.parametrize("file", test_files)
+@pytest.mark.parametrize(
+    "rule,sat_class", [(pabumeasures.mes_apr, Cardinality_Sat), (pabumeasures.mes_cost, Cost_Sat)], ids=["apr", "cost"]
+)
+def test_mes_add1(file, rule, sat_class):
+    instance, profile = parse_pabulib(file)
+    pabutools_result = method_of_equal_shares(
+        instance, profile, sat_class=sat_class, tie_breaking=min_cost_tie_breaking, voter_budget_increment=1
+    )
+    result = rule(instance, profile, completion=Completion.ADD1)
+
+    assert sorted(pabutools_result) == sorted(result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule,sat_class", [(pabumeasures.mes_apr, Cardinality_Sat), (pabumeasures.mes_cost, Cost_Sat)], ids=["apr", "cost"]
+)
+def test_mes_add1_random(seed, rule, sat_class):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    pabutools_result = method_of_equal_shares(
+        instance, profile, sat_class=sat_class, tie_breaking=min_cost_tie_breaking, voter_budget_increment=1
+    )
+    result = rule(instance, profile, completion=Completion.ADD1)
+
+    assert sorted(pabutools_result) == sorted(result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule,sat_class", [(pabumeasures.mes_apr, Cardinality_Sat), (pabumeasures.mes_cost, Cost_Sat)], ids=["apr", "cost"]
+)
+def test_mes_add1u_random(seed, rule, sat_class):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    pabutools_result = completion_by_rule_combination(
+        instance,
+        profile,
+        [method_of_equal_shares, greedy_utilitarian_welfare],
+        [
+            {"sat_class": sat_class, "tie_breaking": min_cost_tie_breaking, "voter_budget_increment": 1},
+            {"sat_class": sat_class, "tie_breaking": min_cost_tie_breaking},
+        ],
+    )
+    result = rule(instance, profile, completion=Completion.ADD1U)
+
+    assert sorted(pabutools_result) == sorted(result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+def test_greedy_over_cost_cardinal_random(seed):
+    random.seed(seed)
+    instance, profile = get_random_cardinal_election()
+    pabutools_result = greedy_utilitarian_welfare(
+        instance, profile, sat_class=Additive_Cardinal_Sat, tie_breaking=min_cost_tie_breaking
+    )
+    result = pabumeasures.greedy_over_cost(instance, profile)
+
+    assert sorted(pabutools_result) == sorted(result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+def test_mes_apr_cardinal_random(seed):
+    random.seed(seed)
+    instance, profile = get_random_cardinal_election()
+    pabutools_result = method_of_equal_shares(
+        instance, profile, sat_class=Additive_Cardinal_Sat, tie_breaking=min_cost_tie_breaking
+    )
+    result = pabumeasures.mes_apr(instance, profile)
+
+    assert sorted(pabutools_result) == sorted(result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule",
+    [
+        pabumeasures.greedy,
+        pabumeasures.greedy_over_cost,
+        pabumeasures.mes_apr,
+        pabumeasures.mes_cost,
+        pabumeasures.mes_sqrt_cost,
+    ],
+)
+def test_cardinal_rules_on_approval_ballots_random(seed, rule):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    cardinal_profile = CardinalProfile(
+        [CardinalBallot({project: 1 for project in ballot}) for ballot in profile], instance=instance
+    )
+
+    assert rule(instance, cardinal_profile) == rule(instance, profile)
+
+
 @pytest.mark.parametrize("file", test_files)
 def test_phragmen(file):
     instance, profile = parse_pabulib(file)
@@ -155,3 +272,307 @@ def test_phragmen_random(seed):
     result = pabumeasures.phragmen(instance, profile)
 
     assert sorted(pabutools_result) == sorted(result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize("exact", [False, True])
+def test_committee_random(seed, exact):
+    random.seed(seed)
+    instance, profile = get_random_election(num_projects=8, min_cost=3, max_cost=3, num_agents=10)
+
+    for rule, pabutools_result in [
+        (
+            pabumeasures.mes_apr,
+            method_of_equal_shares(instance, profile, sat_class=Cardinality_Sat, tie_breaking=min_cost_tie_breaking),
+        ),
+        (
+            pabumeasures.mes_cost,
+            method_of_equal_shares(instance, profile, sat_class=Cost_Sat, tie_breaking=min_cost_tie_breaking),
+        ),
+        (pabumeasures.phragmen, sequential_phragmen(instance, profile, tie_breaking=min_cost_tie_breaking)),
+    ]:
+        assert sorted(rule(instance, profile, exact=exact)) == sorted(pabutools_result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule", [pabumeasures.mes_apr, pabumeasures.mes_cost, pabumeasures.mes_sqrt_cost, pabumeasures.phragmen]
+)
+def test_parallel_rules_random(seed, rule):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    sequential_result = rule(instance, profile)
+    for num_threads in [0, 2, 4]:
+        assert list(rule(instance, profile, num_threads=num_threads)) == list(sequential_result)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule", [pabumeasures.mes_apr, pabumeasures.mes_cost, pabumeasures.mes_sqrt_cost, pabumeasures.phragmen]
+)
+def test_round_log_random(seed, rule):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    log = pabumeasures.RoundLog()
+    result = rule(instance, profile, log=log)
+
+    assert [log.projects[i] for i in log.winners] == list(result)
+    assert len(log.prices) == len(result)
+    assert log.payment_offsets[0] == 0 and log.payment_offsets[-1] == len(log.payment_amounts)
+    class_sizes = Counter(log.voter_classes.tolist())
+    for r, winner in enumerate(log.winners):
+        project = log.projects[winner]
+        begin, end = log.payment_offsets[r], log.payment_offsets[r + 1]
+        classes = log.payment_voter_classes[begin:end].tolist()
+        amounts = log.payment_amounts[begin:end].tolist()
+        assert set(classes) == {log.voter_classes[i] for i, ballot in enumerate(profile) if project in ballot}
+        assert all(amount >= 0 for amount in amounts)
+        if classes:  # Phragmén selects projects without approvers only once nothing else is left, without payments
+            assert sum(class_sizes[c] * amount for c, amount in zip(classes, amounts)) == pytest.approx(project.cost)
+    winners = log.winners
+    assert list(rule(instance, profile, log=log)) == list(result)  # a reused log is cleared first
+    assert len(log.winners) == len(result)
+    assert log.winners.base is not winners.base  # columns read earlier keep their own buffers
+    assert winners.tolist() == log.winners.tolist()
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize("cardinal", [False, True])
+def test_election_file_random(seed, cardinal, tmp_path):
+    random.seed(seed)
+    instance, profile = get_random_cardinal_election() if cardinal else get_random_election()
+    path = tmp_path / "election.pbe"
+    pabumeasures.save_election(instance, profile, path)
+    election = pabumeasures.load_election(path)
+
+    projects = sorted(instance)
+    assert election.budget == instance.budget_limit
+    assert election.num_of_voters == len(profile)
+    assert [project.name for project in election.projects] == [project.name for project in projects]
+    assert [project.cost for project in election.projects] == [project.cost for project in projects]
+    result = pabumeasures._core.mes_cost(election, pabumeasures.ProjectComparator.ByCostAsc)
+    expected = pabumeasures.mes_cost(instance, profile)
+    assert [project.name for project in result] == [project.name for project in expected]
+
+
+@pytest.mark.parametrize("file", test_files)
+def test_convert_pabulib(file, tmp_path):
+    instance, profile = parse_pabulib(file)
+    path = tmp_path / "election.pbe"
+    pabumeasures.convert_pabulib(file, path)
+    election = pabumeasures.load_election(path)
+
+    result = pabumeasures._core.greedy(election, pabumeasures.ProjectComparator.ByCostAsc)
+    assert [project.name for project in result] == [project.name for project in pabumeasures.greedy(instance, profile)]
+
+
+def _shared_mes_cost_winners(name):
+    return [project.name for project in pabumeasures.mes_cost(pabumeasures.PreparedElection.attach(name))]
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="POSIX shared memory")
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES // 10)))
+@pytest.mark.parametrize("cardinal", [False, True])
+def test_shared_election_random(seed, cardinal):
+    random.seed(seed)
+    instance, profile = get_random_cardinal_election() if cardinal else get_random_election()
+    name = f"pabumeasures-test-{os.getpid()}-{seed}-{cardinal}"
+    pabumeasures.share_election(instance, profile, name)
+    try:
+        election = pabumeasures.attach_election(name)
+        with pytest.raises(OSError):
+            pabumeasures.share_election(instance, profile, name)  # the name is taken
+    finally:
+        pabumeasures.unlink_shared_election(name)
+
+    assert election.num_of_voters == len(profile)  # still valid after unlinking
+    assert [project.name for project in election.projects] == [project.name for project in sorted(instance)]
+    result = pabumeasures._core.mes_cost(election, pabumeasures.ProjectComparator.ByCostAsc)
+    expected = pabumeasures.mes_cost(instance, profile)
+    assert [project.name for project in result] == [project.name for project in expected]
+    with pytest.raises(OSError):
+        pabumeasures.attach_election(name)
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="POSIX shared memory")
+def test_shared_election_in_worker_processes():
+    random.seed(0)
+    instance, profile = get_random_election(num_projects=10, max_cost=10, num_agents=50)
+    name = f"pabumeasures-test-{os.getpid()}"
+    pabumeasures.share_election(instance, profile, name)
+    try:
+        with ProcessPoolExecutor(2, mp_context=multiprocessing.get_context("spawn")) as executor:
+            results = list(executor.map(_shared_mes_cost_winners, [name] * 2))
+    finally:
+        pabumeasures.unlink_shared_election(name)
+    assert results == [[project.name for project in pabumeasures.mes_cost(instance, profile)]] * 2
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule",
+    [
+        pabumeasures.greedy,
+        pabumeasures.greedy_over_cost,
+        pabumeasures.mes_apr,
+        pabumeasures.mes_cost,
+        pabumeasures.mes_sqrt_cost,
+        pabumeasures.phragmen,
+    ],
+)
+def test_prepared_election_random(seed, rule, tmp_path):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    expected = list(rule(instance, profile))
+    prepared = pabumeasures.PreparedElection(instance, profile)
+    assert list(rule(prepared)) == expected
+    assert list(rule(prepared)) == expected  # from the cache
+    assert list(rule(prepared, tie_breaking=pabumeasures.ProjectComparator.ByCostDesc)) == list(
+        rule(instance, profile, tie_breaking=pabumeasures.ProjectComparator.ByCostDesc)
+    )
+
+    path = tmp_path / "election.pbe"
+    pabumeasures.save_election(instance, profile, path)
+    loaded = pabumeasures.PreparedElection.load(path)
+    assert [project.name for project in rule(loaded)] == [project.name for project in expected]
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+def test_exact_rules_random(seed):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    assert isinstance(profile, ApprovalProfile)  # for type checking
+    pabutools_results = [
+        method_of_equal_shares(instance, profile, sat_class=Cardinality_Sat, tie_breaking=min_cost_tie_breaking),
+        method_of_equal_shares(instance, profile, sat_class=Cost_Sat, tie_breaking=min_cost_tie_breaking),
+        sequential_phragmen(instance, profile, tie_breaking=min_cost_tie_breaking),
+    ]
+    rules = [pabumeasures.mes_apr, pabumeasures.mes_cost, pabumeasures.phragmen]
+    for rule, pabutools_result in zip(rules, pabutools_results):
+        result = rule(instance, profile, exact=True)
+        assert sorted(pabutools_result) == sorted(result)
+        assert list(result) == list(rule(instance, profile))
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule,sweep",
+    [
+        (pabumeasures.greedy, pabumeasures.greedy_sweep),
+        (pabumeasures.greedy_over_cost, pabumeasures.greedy_over_cost_sweep),
+        (pabumeasures.mes_apr, pabumeasures.mes_apr_sweep),
+        (pabumeasures.mes_cost, pabumeasures.mes_cost_sweep),
+        (pabumeasures.mes_sqrt_cost, pabumeasures.mes_sqrt_cost_sweep),
+        (pabumeasures.phragmen, pabumeasures.phragmen_sweep),
+    ],
+    ids=["greedy", "greedy_over_cost", "mes_apr", "mes_cost", "mes_sqrt_cost", "phragmen"],
+)
+def test_sweep_random(seed, rule, sweep):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    total_cost = sum(project.cost for project in instance)
+    budgets = [random.randint(max(project.cost for project in instance), total_cost) for _ in range(5)]
+    results = sweep(instance, profile, budgets)
+
+    assert len(results) == len(budgets)
+    for budget, result in zip(budgets, results):
+        instance.budget_limit = budget
+        assert list(result) == list(rule(instance, profile))
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "over_cost,rule,rule_measure",
+    [
+        (False, pabumeasures.greedy, pabumeasures.greedy_measure),
+        (True, pabumeasures.greedy_over_cost, pabumeasures.greedy_over_cost_measure),
+    ],
+    ids=["greedy", "greedy_over_cost"],
+)
+@pytest.mark.parametrize(
+    "tie_breaking", [pabumeasures.ProjectComparator.ByCostAsc, pabumeasures.ProjectComparator.ByCostDesc]
+)
+def test_greedy_tally_random(seed, over_cost, rule, rule_measure, tie_breaking):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    tally = pabumeasures.GreedyTally(instance, over_cost=over_cost, tie_breaking=tie_breaking)
+    ballots = ApprovalProfile()
+    for ballot in profile:
+        tally.add_ballot(ballot)
+        ballots.append(ballot)
+        if random.random() < 0.3:
+            tally.retract_ballot(ballots.pop(random.randrange(len(ballots))))
+        if len(ballots) == 0:
+            continue
+        assert list(tally.allocation()) == list(rule(instance, ballots, tie_breaking))
+        for project in instance:
+            assert tally.cost_reduction(project) == rule_measure(
+                instance, ballots, project, Measure.COST_REDUCTION, tie_breaking
+            )
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize("rule", [pabumeasures.mes_apr, pabumeasures.mes_cost, pabumeasures.phragmen])
+def test_recount_random(seed, rule):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    recount = pabumeasures.Recount(instance, profile, rule)
+    ballots = ApprovalProfile(profile)
+    for _ in range(5):
+        ballot = ApprovalBallot(random.sample(sorted(instance), random.randint(0, len(instance))))
+        recount.add_ballot(ballot)
+        ballots.append(ballot)
+        if random.random() < 0.5:
+            recount.retract_ballot(ballots.pop(random.randrange(len(ballots))))
+        winners = recount.allocation()
+        assert list(winners) == list(rule(instance, ballots))
+        assert 0 <= recount.resumed_round <= len(winners)
+
+        # a ballot added and retracted again changes nothing, so no round is rerun
+        recount.add_ballot(ballot)
+        recount.retract_ballot(ballot)
+        assert list(recount.allocation()) == list(winners)
+        assert recount.resumed_round == len(winners)
+
+
+@pytest.mark.parametrize("rule", [pabumeasures.mes_apr, pabumeasures.mes_cost, pabumeasures.phragmen])
+def test_recount_resumes_late_rounds(rule):
+    p1, p2, p3 = Project("p1", 3), Project("p2", 3), Project("p3", 3)
+    instance = Instance([p1, p2, p3], 12)
+    ballots = ApprovalProfile([ApprovalBallot([p1])] * 6 + [ApprovalBallot([p2])] * 4 + [ApprovalBallot([p3])] * 2)
+    recount = pabumeasures.Recount(instance, ballots, rule)
+    assert list(recount.allocation()) == list(rule(instance, ballots))
+
+    # moving a voter keeps the number of voters (and so the MES budgets), and p1 still wins the first round
+    recount.retract_ballot(ApprovalBallot([p3]))
+    recount.add_ballot(ApprovalBallot([p2, p3]))
+    ballots.remove(ApprovalBallot([p3]))
+    ballots.append(ApprovalBallot([p2, p3]))
+    winners = recount.allocation()
+    assert list(winners) == list(rule(instance, ballots))
+    assert 0 < recount.resumed_round <= len(winners)
+
+
+@pytest.mark.parametrize("seed", list(range(NUMBER_OF_TIMES)))
+@pytest.mark.parametrize(
+    "rule",
+    [
+        pabumeasures.greedy,
+        pabumeasures.greedy_over_cost,
+        pabumeasures.mes_apr,
+        pabumeasures.mes_cost,
+        pabumeasures.phragmen,
+    ],
+)
+def test_selection_frequencies_random(seed, rule):
+    random.seed(seed)
+    instance, profile = get_random_election()
+    winners = rule(instance, profile)
+    # dropping nobody reruns the rule on the same profile
+    frequencies = pabumeasures.selection_frequencies(instance, profile, rule, 10, drop_fraction=0.0)
+    assert list(frequencies) == [1.0 if project in winners else 0.0 for project in sorted(instance)]
+
+    frequencies = pabumeasures.selection_frequencies(instance, profile, rule, 50, seed=seed)
+    assert all(0 <= frequency <= 1 for frequency in frequencies)
+    parallel_frequencies = pabumeasures.selection_frequencies(instance, profile, rule, 50, seed=seed, num_threads=3)
+    assert list(frequencies) == list(parallel_frequencies)
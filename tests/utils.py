@@ -4,7 +4,14 @@
 import random
 from math import ceil
 
-from pabutools.election import ApprovalProfile, Instance, Project, get_random_approval_profile
+from pabutools.election import (
+    ApprovalProfile,
+    CardinalBallot,
+    CardinalProfile,
+    Instance,
+    Project,
+    get_random_approval_profile,
+)
 
 
 def get_random_election(
@@ -16,6 +23,21 @@ def get_random_election(
     return instance, profile
 
 
+def get_random_cardinal_election(
+    num_projects: int = 3, min_cost: int = 1, max_cost: int = 4, num_agents: int = 5, max_utility: int = 3
+) -> tuple[Instance, CardinalProfile]:
+    """Generates and returns a random election (Instance and CardinalProfile) with utilities in [0, max_utility]."""
+    instance = get_random_instance(num_projects, min_cost, max_cost)
+    profile = CardinalProfile(
+        [
+            CardinalBallot({project: random.randint(0, max_utility) for project in sorted(instance)})
+            for _ in range(num_agents)
+        ],
+        instance=instance,
+    )
+    return instance, profile
+
+
 def get_random_project(instance: Instance) -> Project:
     """Selects and returns a random Project from the given Instance."""
     return random.choice(sorted(instance))